@@ -0,0 +1,214 @@
+#include "DamageTracker.hpp"
+#include "Elements/Element.hpp"
+#include "GUIManagerID.hpp"
+#include <algorithm>
+#include <cmath>
+#include <string_view>
+
+namespace GUIStuff {
+
+namespace {
+    void hash_color(uint64_t& h, const Clay_Color& c) {
+        hash_combine(h, c.r);
+        hash_combine(h, c.g);
+        hash_combine(h, c.b);
+        hash_combine(h, c.a);
+    }
+
+    void hash_corners(uint64_t& h, const Clay_CornerRadius& r) {
+        hash_combine(h, r.topLeft);
+        hash_combine(h, r.topRight);
+        hash_combine(h, r.bottomLeft);
+        hash_combine(h, r.bottomRight);
+    }
+
+    SkIRect drawn_irect(const Clay_RenderCommand& c, int32_t margin) {
+        SkRect r = SkRect::MakeXYWH(c.boundingBox.x, c.boundingBox.y, c.boundingBox.width, c.boundingBox.height);
+        if(c.commandType == CLAY_RENDER_COMMAND_TYPE_BORDER) {
+            const Clay_BorderWidth& w = c.renderData.border.width;
+            float halfWidth = std::max({w.left, w.right, w.top, w.bottom}) * 0.5f;
+            r.outset(halfWidth, halfWidth);
+        }
+        return r.roundOut().makeOutset(margin, margin);
+    }
+}
+
+void DamageTracker::update(std::span<const Clay_RenderCommand> commands, const SkIRect& windowRect) {
+    if(windowRect != lastWindowRect) {
+        lastWindowRect = windowRect;
+        invalidated = true;
+    }
+
+    current.clear();
+    clipStack.clear();
+    clipStack.emplace_back(windowRect);
+    damageRects.clear();
+
+    for(const Clay_RenderCommand& c : commands) {
+        uint64_t h = 0;
+        hash_combine(h, static_cast<int>(c.commandType));
+        switch(c.commandType) {
+            case CLAY_RENDER_COMMAND_TYPE_SCISSOR_START: {
+                SkIRect clip = SkRect::MakeXYWH(c.boundingBox.x, c.boundingBox.y, c.boundingBox.width, c.boundingBox.height).roundOut();
+                if(!clip.intersect(clipStack.back()))
+                    clip.setEmpty();
+                clipStack.emplace_back(clip);
+                continue;
+            }
+            case CLAY_RENDER_COMMAND_TYPE_SCISSOR_END:
+                if(clipStack.size() > 1)
+                    clipStack.pop_back();
+                continue;
+            case CLAY_RENDER_COMMAND_TYPE_RECTANGLE:
+                hash_color(h, c.renderData.rectangle.backgroundColor);
+                hash_corners(h, c.renderData.rectangle.cornerRadius);
+                break;
+            case CLAY_RENDER_COMMAND_TYPE_BORDER: {
+                const Clay_BorderRenderData& b = c.renderData.border;
+                hash_color(h, b.color);
+                hash_corners(h, b.cornerRadius);
+                hash_combine(h, b.width.left);
+                hash_combine(h, b.width.right);
+                hash_combine(h, b.width.top);
+                hash_combine(h, b.width.bottom);
+                break;
+            }
+            case CLAY_RENDER_COMMAND_TYPE_TEXT: {
+                const Clay_TextRenderData& t = c.renderData.text;
+                hash_combine(h, std::string_view(t.stringContents.chars, t.stringContents.length));
+                hash_color(h, t.textColor);
+                hash_combine(h, t.fontSize);
+                hash_combine(h, t.letterSpacing);
+                break;
+            }
+            case CLAY_RENDER_COMMAND_TYPE_CUSTOM: {
+                const Element* customElement = static_cast<const Element*>(c.renderData.custom.customData);
+                std::optional<uint64_t> contentHash = customElement->content_hash();
+                if(!contentHash) {
+                    SkIRect r = drawn_irect(c, DAMAGE_MARGIN);
+                    if(r.intersect(clipStack.back()))
+                        add_damage(r);
+                    continue;
+                }
+                hash_combine(h, customElement);
+                hash_combine(h, contentHash.value());
+                break;
+            }
+            default:
+                break;
+        }
+        hash_combine(h, c.boundingBox.x);
+        hash_combine(h, c.boundingBox.y);
+        hash_combine(h, c.boundingBox.width);
+        hash_combine(h, c.boundingBox.height);
+
+        // Commands outside of their clip never show up, so they can't damage anything
+        SkIRect r = drawn_irect(c, DAMAGE_MARGIN);
+        if(!r.intersect(clipStack.back()))
+            continue;
+        hash_combine(h, r.fLeft);
+        hash_combine(h, r.fTop);
+        hash_combine(h, r.fRight);
+        hash_combine(h, r.fBottom);
+        current.push_back({h, r});
+    }
+
+    std::sort(current.begin(), current.end());
+
+    if(invalidated) {
+        invalidated = false;
+        fullDamage = true;
+        damageRects.assign(1, windowRect);
+        std::swap(previous, current);
+        return;
+    }
+
+    // Both lists are sorted by hash, so commands that are in only one of them are found in one pass.
+    // Equal hashes are matched one to one, so a command that's duplicated or removed from a set of identical ones is still caught
+    auto prevIt = previous.begin();
+    auto currIt = current.begin();
+    while(prevIt != previous.end() || currIt != current.end()) {
+        if(currIt == current.end() || (prevIt != previous.end() && prevIt->hash < currIt->hash))
+            add_damage((prevIt++)->rect);
+        else if(prevIt == previous.end() || currIt->hash < prevIt->hash)
+            add_damage((currIt++)->rect);
+        else {
+            prevIt++;
+            currIt++;
+        }
+    }
+
+    std::swap(previous, current);
+
+    fullDamage = false;
+    coalesce_damage();
+}
+
+void DamageTracker::add_damage(const SkIRect& rect) {
+    if(!rect.isEmpty())
+        damageRects.emplace_back(rect);
+}
+
+void DamageTracker::coalesce_damage() {
+    float fullDamageArea = fullDamageFraction * static_cast<float>(lastWindowRect.width()) * static_cast<float>(lastWindowRect.height());
+    // Overlapping rects are counted twice here, which only makes giving up early more likely
+    if(damageRects.size() > maxRects * 4 || static_cast<float>(damaged_area()) > fullDamageArea) {
+        fullDamage = true;
+        damageRects.assign(1, lastWindowRect);
+        return;
+    }
+
+    // Each rect absorbs every merged rect it overlaps before being added, so the merged rects never overlap.
+    // Every absorbed rect leaves the list, so this is at most quadratic in the number of rects
+    std::sort(damageRects.begin(), damageRects.end(), [](const SkIRect& a, const SkIRect& b) {
+        return a.fTop < b.fTop;
+    });
+    mergedRects.clear();
+    for(SkIRect r : damageRects) {
+        for(size_t j = 0; j < mergedRects.size();) {
+            if(SkIRect::Intersects(r, mergedRects[j])) {
+                r.join(mergedRects[j]);
+                mergedRects[j] = mergedRects.back();
+                mergedRects.pop_back();
+                j = 0;
+            }
+            else
+                j++;
+        }
+        mergedRects.emplace_back(r);
+    }
+    std::swap(damageRects, mergedRects);
+
+    if(damageRects.size() > maxRects || static_cast<float>(damaged_area()) > fullDamageArea) {
+        fullDamage = true;
+        damageRects.assign(1, lastWindowRect);
+    }
+}
+
+void DamageTracker::invalidate() {
+    invalidated = true;
+}
+
+void DamageTracker::damage_all(const SkIRect& windowRect) {
+    lastWindowRect = windowRect;
+    invalidated = true;
+    fullDamage = true;
+    damageRects.assign(1, windowRect);
+}
+
+const std::vector<SkIRect>& DamageTracker::damage() const {
+    return damageRects;
+}
+
+bool DamageTracker::full_damage() const {
+    return fullDamage;
+}
+
+int64_t DamageTracker::damaged_area() const {
+    int64_t area = 0;
+    for(const SkIRect& r : damageRects)
+        area += static_cast<int64_t>(r.width()) * r.height();
+    return area;
+}
+
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include "include/core/SkRect.h"
+#include <vector>
+#include <span>
+#include <cstdint>
+
+#pragma GCC diagnostic push 
+#pragma GCC diagnostic ignored "-Wunused-variable"
+#include <clay.h>
+#pragma GCC diagnostic pop
+
+namespace GUIStuff {
+
+// Finds the parts of the window that changed since the last frame, by comparing a signature of every render command
+// against the last frame's. Commands that were added, removed or changed damage their bounding box (in both frames' positions).
+// Custom elements are compared with Element::content_hash. All of this library's custom elements have one; an element without
+// one damages its bounding box every frame
+class DamageTracker {
+    public:
+        void update(std::span<const Clay_RenderCommand> commands, const SkIRect& windowRect);
+        void invalidate(); // Damages the whole window on the next update
+        void damage_all(const SkIRect& windowRect); // Damages the whole window now, without looking at the commands
+
+        const std::vector<SkIRect>& damage() const; // Window coordinates, doesn't overlap. Empty if nothing changed
+        bool full_damage() const; // Damage is just the whole window
+        int64_t damaged_area() const;
+
+        // Past this many rects (or four times as many before they're merged), or this fraction of the window, the damage
+        // becomes the whole window since clipping to many small rects stops being cheaper than redrawing
+        size_t maxRects = 16;
+        float fullDamageFraction = 0.5f;
+    private:
+        // Text and custom elements can draw slightly outside their bounding box (glyph overhang, strokes, antialiasing)
+        static constexpr int32_t DAMAGE_MARGIN = 4;
+
+        struct CommandSignature {
+            uint64_t hash;
+            SkIRect rect;
+            bool operator<(const CommandSignature& other) const { return hash < other.hash; }
+        };
+
+        void add_damage(const SkIRect& rect);
+        void coalesce_damage();
+
+        std::vector<CommandSignature> previous;
+        std::vector<CommandSignature> current;
+        std::vector<SkIRect> clipStack;
+        std::vector<SkIRect> damageRects;
+        std::vector<SkIRect> mergedRects;
+        SkIRect lastWindowRect = SkIRect::MakeEmpty();
+        bool invalidated = true;
+        bool fullDamage = true;
+};
+
+}
@@ -4,7 +4,7 @@
 
 namespace GUIStuff {
 
-void CheckBox::update(UpdateInputData& io, bool newIsTicked, const std::function<void()>& elemUpdate) {
+void CheckBox::update(UpdateInputData& io, bool newIsTicked, FunctionRef<void()> elemUpdate) {
     CLAY({
         .layout = {
             .sizing = {.width = CLAY_SIZING_FIXED(20), .height = CLAY_SIZING_FIXED(20)}
@@ -65,7 +65,7 @@ void CheckBox::clay_draw(SkCanvas* canvas, UpdateInputData& io, Clay_RenderComma
 
         static BezierEasing anim{0.445, -0.733, 0.575, 1.627};
 
-        float lerpTime2 = anim(smooth_two_way_time(hoverAnimation2, io.deltaTime, selection.hovered, CHECKBOX_ANIMATION_TIME));
+        float lerpTime2 = anim(animate_two_way_time(io, hoverAnimation2, selection.hovered, CHECKBOX_ANIMATION_TIME));
 
         std::array<Vector2f, 5> points;
 
@@ -87,4 +87,12 @@ void CheckBox::clay_draw(SkCanvas* canvas, UpdateInputData& io, Clay_RenderComma
     canvas->restore();
 }
 
+std::optional<uint64_t> CheckBox::content_hash() const {
+    uint64_t h = 0;
+    hash_combine(h, isTicked);
+    hash_combine(h, selection.hovered);
+    hash_combine(h, hoverAnimation2);
+    return h;
+}
+
 }
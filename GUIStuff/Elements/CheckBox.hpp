@@ -5,8 +5,9 @@ namespace GUIStuff {
 
 class CheckBox : public Element {
     public:
-        void update(UpdateInputData& io, bool newIsTicked, const std::function<void()>& elemUpdate);
+        void update(UpdateInputData& io, bool newIsTicked, FunctionRef<void()> elemUpdate);
         virtual void clay_draw(SkCanvas* canvas, UpdateInputData& io, Clay_RenderCommand* command) override;
+        virtual std::optional<uint64_t> content_hash() const override;
         SelectionHelper selection;
     private:
         static constexpr float CHECKBOX_ANIMATION_TIME = 0.3;
@@ -11,7 +11,7 @@ namespace GUIStuff {
 
 template <typename T> class ColorPicker : public Element {
     public:
-        void update(UpdateInputData& io, T* newData, bool newSelectAlpha, const std::function<void()>& elemUpdate) {
+        void update(UpdateInputData& io, T* newData, bool newSelectAlpha, FunctionRef<void()> elemUpdate) {
             data = newData;
             selectAlpha = newSelectAlpha;
 
@@ -127,6 +127,18 @@ template <typename T> class ColorPicker : public Element {
 
             canvas->restore();
         }
+
+        virtual std::optional<uint64_t> content_hash() const override {
+            uint64_t h = 0;
+            hash_combine(h, selectAlpha);
+            if(data) {
+                for(Eigen::Index i = 0; i < data->size(); i++)
+                    hash_combine(h, (*data)[i]);
+            }
+            for(Eigen::Index i = 0; i < savedHsv.size(); i++)
+                hash_combine(h, savedHsv[i]);
+            return h;
+        }
     private:
         void force_update_colorpicker() {
             if(data && (*data == oldData))
@@ -1,6 +1,86 @@
 #include "Element.hpp"
+#include <cstring>
 
 namespace GUIStuff {
+    StringArena::StringArena(size_t initialChunkSize):
+        initialChunkSize(initialChunkSize)
+    {
+        replace_chunks(initialChunkSize);
+    }
+
+    void StringArena::reset() {
+        peakBytes = std::max(peakBytes, bytesUsed);
+        intervalPeakBytes = std::max(intervalPeakBytes, bytesUsed);
+
+        // If the last frame spilled into more chunks, merge them into one chunk that fits the whole frame
+        if(chunkIndex != 0)
+            replace_chunks(bytesUsed + bytesUsed / 2);
+        else if(++resetsSinceShrinkCheck >= SHRINK_CHECK_INTERVAL) {
+            // Shrink back towards the working set of the last interval if it has been much smaller than the capacity
+            size_t target = std::max(initialChunkSize, intervalPeakBytes * 2);
+            if(capacity() > target * 2)
+                replace_chunks(target);
+            resetsSinceShrinkCheck = 0;
+            intervalPeakBytes = 0;
+        }
+
+        chunkIndex = 0;
+        indexInChunk = 0;
+        bytesUsed = 0;
+    }
+
+    char* StringArena::allocate(size_t size) {
+        if(indexInChunk + size > chunks[chunkIndex].size) {
+            // Skip to a later chunk that fits, or add a new one. Earlier chunks are kept since Clay still points into them
+            chunkIndex++;
+            while(chunkIndex < chunks.size() && chunks[chunkIndex].size < size)
+                chunkIndex++;
+            if(chunkIndex >= chunks.size()) {
+                size_t newSize = std::max(size, chunks.back().size * 2);
+                chunks.emplace_back(Chunk{std::make_unique<char[]>(newSize), newSize});
+                chunkIndex = chunks.size() - 1;
+            }
+            indexInChunk = 0;
+        }
+        char* toRet = chunks[chunkIndex].data.get() + indexInChunk;
+        indexInChunk += size;
+        bytesUsed += size;
+        return toRet;
+    }
+
+    const char* StringArena::insert_string_into_arena(std::string_view str) {
+        size_t strSize = str.size();
+        char* startPtr = allocate(strSize + 1);
+        std::memcpy(startPtr, str.data(), strSize);
+        startPtr[strSize] = ' ';
+        return startPtr;
+    }
+
+    Clay_String StringArena::std_str_to_clay_str(std::string_view str) {
+        return Clay_String{.length = static_cast<int32_t>(str.size()), .chars = insert_string_into_arena(str)};
+    }
+
+    size_t StringArena::bytes_used() const {
+        return bytesUsed;
+    }
+
+    size_t StringArena::peak_bytes() const {
+        return std::max(peakBytes, bytesUsed);
+    }
+
+    size_t StringArena::capacity() const {
+        size_t toRet = 0;
+        for(const Chunk& c : chunks)
+            toRet += c.size;
+        return toRet;
+    }
+
+    void StringArena::replace_chunks(size_t newSize) {
+        newSize = std::max(newSize, initialChunkSize);
+        chunks.clear();
+        chunks.emplace_back(Chunk{std::make_unique<char[]>(newSize), newSize});
+    }
+
     SkFont get_setup_skfont() {
         SkFont font;
         font.setLinearMetrics(true);
@@ -38,6 +118,13 @@ namespace GUIStuff {
         return toRet;
     }
     
+    float animate_two_way_time(UpdateInputData& io, float& animTime, bool forward, float maxTime) {
+        float toRet = smooth_two_way_time(animTime, io.deltaTime, forward, maxTime);
+        if(forward ? animTime < maxTime : animTime > 0.0f)
+            io.frameRequested = true;
+        return toRet;
+    }
+
     void SelectionHelper::update(bool isHovering, bool isLeftClick, bool isLeftHeld) {
         hovered = isHovering;
     
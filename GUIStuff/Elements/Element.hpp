@@ -3,42 +3,53 @@
 #include "include/core/SkCanvas.h"
 #include "../../TimePoint.hpp"
 #include <Eigen/Dense>
+#include <Helpers/Hashes.hpp>
+#include <optional>
 #include "include/core/SkFont.h"
 #include "include/core/SkFontMgr.h"
 #include "modules/svg/include/SkSVGDOM.h"
+#include "../FunctionRef.hpp"
+#include "../FrameArena.hpp"
 
 using namespace Eigen;
 
 namespace GUIStuff {
 
-// Taken from https://github.com/TimothyHoytBSME/ClayMan (rewritten to be a separate struct, and use templates to change size)
-template <size_t S> class StringArena {
+// Taken from https://github.com/TimothyHoytBSME/ClayMan (rewritten to be a separate struct, and to grow in chunks)
+// Strings inserted stay valid until the next reset, even if the arena has to add a chunk to fit more
+class StringArena {
     public:
-        StringArena() {
-            stringArena = std::vector<char>(S);
-        }
-        void reset() {
-            stringArenaIndex = 0;
-        }
-        const char* insert_string_into_arena(const std::string& str) {
-            size_t strSize = str.size();
-            if(stringArenaIndex + strSize + 1 > S)
-                throw std::overflow_error("[StringArena::insert_string_into_arena] Not enough space to insert string");
-            char* startPtr = &stringArena[stringArenaIndex];
-            for(size_t i = 0; i < strSize; i++)
-                stringArena[stringArenaIndex++] = str[i];
-            stringArena[stringArenaIndex++] = ' ';
-            return startPtr;
-        }
-        Clay_String std_str_to_clay_str(const std::string& str) {
-            return Clay_String{.length = static_cast<int32_t>(str.size()), .chars = insert_string_into_arena(str)};
-        }
+        StringArena(size_t initialChunkSize = 16384);
+        void reset();
+        char* allocate(size_t size);
+        const char* insert_string_into_arena(std::string_view str);
+        Clay_String std_str_to_clay_str(std::string_view str);
+
+        size_t bytes_used() const; // Bytes inserted since the last reset
+        size_t peak_bytes() const; // Largest bytes_used seen
+        size_t capacity() const;
     private:
-        std::vector<char> stringArena;
-        size_t stringArenaIndex;
+        static constexpr size_t SHRINK_CHECK_INTERVAL = 300;
+
+        struct Chunk {
+            std::unique_ptr<char[]> data;
+            size_t size;
+        };
+
+        void replace_chunks(size_t newSize);
+
+        std::vector<Chunk> chunks;
+        size_t chunkIndex = 0;
+        size_t indexInChunk = 0;
+        size_t initialChunkSize;
+
+        size_t bytesUsed = 0;
+        size_t peakBytes = 0;
+        size_t intervalPeakBytes = 0;
+        size_t resetsSinceShrinkCheck = 0;
 };
 
-typedef StringArena<4000000> DefaultStringArena;
+typedef StringArena DefaultStringArena;
 
 SkFont get_setup_skfont();
 
@@ -100,6 +111,9 @@ struct UpdateInputData {
     float deltaTime = 0.0f;
     sk_sp<SkFontMgr> textFontMgr;
     DefaultStringArena* strArena;
+    FrameArena* frameArena; // Memory that is released when the next frame begins
+    size_t textBoxRelayoutCount = 0; // Times a TextBox editor had its font, font manager or width changed, which makes it lay out its text again
+    bool frameRequested = false; // Set by elements that need another frame without new input, ex. while an animation is playing. Cleared on begin
     std::shared_ptr<Theme> theme;
     std::unordered_map<std::string, sk_sp<SkSVGDOM>> svgData;
 };
@@ -114,6 +128,9 @@ class SelectionHelper {
         bool justUnselected = false;
 };
 
+// smooth_two_way_time that keeps requesting frames until the animation reaches whichever end it's heading to
+float animate_two_way_time(UpdateInputData& io, float& animTime, bool forward, float maxTime);
+
 struct ElemBoundingBox {
     Vector2f pos;
     Vector2f dim;
@@ -122,6 +139,9 @@ struct ElemBoundingBox {
 class Element {
     public:
         virtual void clay_draw(SkCanvas* canvas, UpdateInputData& io, Clay_RenderCommand* command) = 0;
+        // Hash of the state clay_draw depends on, other than the bounding box and theme. Used to find which parts of the window
+        // changed since the last frame. Elements that return nullopt are redrawn every frame
+        virtual std::optional<uint64_t> content_hash() const { return std::nullopt; }
         virtual ~Element() = default;
 
     protected:
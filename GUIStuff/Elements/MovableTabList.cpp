@@ -2,17 +2,21 @@
 #include "Helpers/ConvertVec.hpp"
 #include "src/GUIStuff/GUIManager.hpp"
 #include <iostream>
+#include <algorithm>
 
 namespace GUIStuff {
 
-void MovableTabList::update(UpdateInputData& io, const std::vector<std::pair<std::string, std::string>>& tabNames, size_t& selectedTab, std::optional<size_t>& closedTab, const std::function<void()>& elemUpdate) {
+void MovableTabList::update(UpdateInputData& io, std::span<const TabName> tabNames, size_t& selectedTab, std::optional<size_t>& closedTab, FunctionRef<void()> elemUpdate) {
     size_t currentSelectedTab = selectedTab;
-    if(tabNames != oldTabNames) {
+    bool tabNamesChanged = !std::equal(tabNames.begin(), tabNames.end(), oldTabNames.begin(), oldTabNames.end(), [](const TabName& a, const std::pair<std::string, std::string>& b) {
+        return a.first == b.first && a.second == b.second;
+    });
+    if(tabNamesChanged) {
         buttons = std::vector<SelectableButton>(tabNames.size());
         closeButtons = std::vector<SelectableButton>(tabNames.size());
         closeIcons = std::vector<SVGIcon>(tabNames.size());
         tabIcons = std::vector<SVGIcon>(tabNames.size());
-        oldTabNames = tabNames;
+        oldTabNames.assign(tabNames.begin(), tabNames.end());
     }
 
     CLAY({.layout = { 
@@ -77,4 +81,9 @@ void MovableTabList::update(UpdateInputData& io, const std::vector<std::pair<std
 void MovableTabList::clay_draw(SkCanvas* canvas, UpdateInputData& io, Clay_RenderCommand* command) {
 }
 
+std::optional<uint64_t> MovableTabList::content_hash() const {
+    // Doesn't draw anything itself, the tabs are drawn by their own elements
+    return 0;
+}
+
 }
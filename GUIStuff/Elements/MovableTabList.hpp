@@ -2,13 +2,17 @@
 #include "Element.hpp"
 #include "SelectableButton.hpp"
 #include "SVGIcon.hpp"
+#include <span>
 
 namespace GUIStuff {
 
 class MovableTabList : public Element {
     public:
-        void update(UpdateInputData& io, const std::vector<std::pair<std::string, std::string>>& tabNames, size_t& selectedTab, std::optional<size_t>& closedTab, const std::function<void()>& elemUpdate);
+        typedef std::pair<std::string_view, std::string_view> TabName; // Icon path (empty for no icon), tab name
+
+        void update(UpdateInputData& io, std::span<const TabName> tabNames, size_t& selectedTab, std::optional<size_t>& closedTab, FunctionRef<void()> elemUpdate);
         virtual void clay_draw(SkCanvas* canvas, UpdateInputData& io, Clay_RenderCommand* command) override;
+        virtual std::optional<uint64_t> content_hash() const override;
         SelectionHelper selection;
     private:
         std::vector<std::pair<std::string, std::string>> oldTabNames;
@@ -5,7 +5,7 @@ namespace GUIStuff {
 
 template <typename T> class NumberSlider : public Element {
     public:
-        void update(UpdateInputData& io, T* dataPtr, T minNew, T maxNew, const std::function<void()>& elemUpdate) {
+        void update(UpdateInputData& io, T* dataPtr, T minNew, T maxNew, FunctionRef<void()> elemUpdate) {
             data = dataPtr;
             min = minNew;
             max = maxNew;
@@ -35,12 +35,12 @@ template <typename T> class NumberSlider : public Element {
             canvas->save();
             canvas->translate(bb.pos.x(), bb.pos.y());
 
-            float lerpTimeHover = smooth_two_way_time(hoverAnimation, io.deltaTime, selection.hovered, io.theme->hoverExpandTime);
+            float lerpTimeHover = animate_two_way_time(io, hoverAnimation, selection.hovered, io.theme->hoverExpandTime);
 
             //static BezierEasing easeHeight(0.75, 0.25, 0.25, 0.75);
             static BezierEasing easeHeight(0.68, -1.55, 0.265, 2.55);
 
-            float lerpTimeHeld = easeHeight(smooth_two_way_time(holdAnimation, io.deltaTime, selection.held, 0.3));
+            float lerpTimeHeld = easeHeight(animate_two_way_time(io, holdAnimation, selection.held, 0.3));
 
             float holderRadius = lerp_vec(4.0, 5.0, lerpTimeHover);
             float holderHeight = lerp_vec(4.0, 10.0, lerpTimeHeld);
@@ -76,6 +76,18 @@ template <typename T> class NumberSlider : public Element {
             canvas->restore();
         }
 
+        virtual std::optional<uint64_t> content_hash() const override {
+            uint64_t h = 0;
+            hash_combine(h, data ? *data : min);
+            hash_combine(h, min);
+            hash_combine(h, max);
+            hash_combine(h, selection.hovered);
+            hash_combine(h, selection.held);
+            hash_combine(h, hoverAnimation);
+            hash_combine(h, holdAnimation);
+            return h;
+        }
+
     private:
         ElemBoundingBox bb;
         SelectionHelper selection;
@@ -2,7 +2,7 @@
 
 namespace GUIStuff {
 
-void RadioButton::update(UpdateInputData& io, bool newIsTicked, const std::function<void()>& elemUpdate) {
+void RadioButton::update(UpdateInputData& io, bool newIsTicked, FunctionRef<void()> elemUpdate) {
     CLAY({
         .layout = {
             .sizing = {.width = CLAY_SIZING_FIXED(20), .height = CLAY_SIZING_FIXED(20)}
@@ -38,7 +38,7 @@ void RadioButton::clay_draw(SkCanvas* canvas, UpdateInputData& io, Clay_RenderCo
         innerCircleP.setStyle(SkPaint::kFill_Style);
 
         static BezierEasing easeRadius(0.68, -2.55, 0.265, 3.55);
-        float lerpTime2 = easeRadius(smooth_two_way_time(hoverAnimation2, io.deltaTime, selection.hovered, RADIOBUTTON_ANIMATION_TIME));
+        float lerpTime2 = easeRadius(animate_two_way_time(io, hoverAnimation2, selection.hovered, RADIOBUTTON_ANIMATION_TIME));
         float innerCircleRadius = lerp_vec(0.3f, 0.2f, lerpTime2);
 
         canvas->drawCircle(0.0f, 0.0f, innerCircleRadius, innerCircleP);
@@ -54,4 +54,12 @@ void RadioButton::clay_draw(SkCanvas* canvas, UpdateInputData& io, Clay_RenderCo
     canvas->restore();
 }
 
+std::optional<uint64_t> RadioButton::content_hash() const {
+    uint64_t h = 0;
+    hash_combine(h, isTicked);
+    hash_combine(h, selection.hovered);
+    hash_combine(h, hoverAnimation2);
+    return h;
+}
+
 }
@@ -8,20 +8,40 @@
 
 namespace GUIStuff {
 
-void SVGIcon::update(UpdateInputData& io, const std::string& newSvgPath, bool newIsHighlighted, const std::function<void()>& elemUpdate) {
+void SVGIcon::update(UpdateInputData& io, std::string_view newSvgPath, bool newIsHighlighted, FunctionRef<void()> elemUpdate) {
+    if(newSvgPath != svgPath)
+        load_svg(io, newSvgPath);
+
+    highlighted = newIsHighlighted;
+
+    CLAY({
+        .layout = {
+            .sizing = {.width = CLAY_SIZING_GROW(0), .height = CLAY_SIZING_GROW(0) }
+        },
+        .custom = { .customData = this }
+    }) {
+        if(elemUpdate)
+            elemUpdate();
+    }
+}
+
+void SVGIcon::load_svg(UpdateInputData& io, std::string_view newSvgPathView) {
+    svgPath = newSvgPathView;
+    const std::string& newSvgPath = svgPath;
     auto findSVGData = io.svgData.find(newSvgPath);
     if(findSVGData == io.svgData.end()) {
         auto stream = SkStream::MakeFromFile(newSvgPath.c_str());
         if(!stream) {
-            std::cout << "[SVGIcon::update] Could not open file " << newSvgPath << std::endl;
+            std::cout << "[SVGIcon::load_svg] Could not open file " << newSvgPath << std::endl;
             io.svgData[newSvgPath] = nullptr;
             svgDom = nullptr;
+            return;
         }
         auto newSvgDom = SkSVGDOM::Builder().make(*stream);
         if(!newSvgDom) {
             io.svgData[newSvgPath] = nullptr;
             svgDom = nullptr;
-            std::cout << "[SVGIcon::update] Could not parse SVG " << newSvgPath << std::endl;
+            std::cout << "[SVGIcon::load_svg] Could not parse SVG " << newSvgPath << std::endl;
         }
         else {
             io.svgData[newSvgPath] = newSvgDom;
@@ -30,18 +50,6 @@ void SVGIcon::update(UpdateInputData& io, const std::string& newSvgPath, bool ne
     }
     else
         svgDom = findSVGData->second;
-
-    highlighted = newIsHighlighted;
-
-    CLAY({
-        .layout = {
-            .sizing = {.width = CLAY_SIZING_GROW(0), .height = CLAY_SIZING_GROW(0) }
-        },
-        .custom = { .customData = this }
-    }) {
-        if(elemUpdate)
-            elemUpdate();
-    }
 }
 
 void SVGIcon::clay_draw(SkCanvas* canvas, UpdateInputData& io, Clay_RenderCommand* command) {
@@ -64,4 +72,11 @@ void SVGIcon::clay_draw(SkCanvas* canvas, UpdateInputData& io, Clay_RenderComman
     canvas->restore();
 }
 
+std::optional<uint64_t> SVGIcon::content_hash() const {
+    uint64_t h = 0;
+    hash_combine(h, svgDom.get());
+    hash_combine(h, highlighted);
+    return h;
+}
+
 }
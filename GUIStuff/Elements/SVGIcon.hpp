@@ -5,10 +5,14 @@ namespace GUIStuff {
 
 class SVGIcon : public Element {
     public:
-        void update(UpdateInputData& io, const std::string& newSvgPath, bool newIsHighlighted, const std::function<void()>& elemUpdate);
+        void update(UpdateInputData& io, std::string_view newSvgPath, bool newIsHighlighted, FunctionRef<void()> elemUpdate);
         virtual void clay_draw(SkCanvas* canvas, UpdateInputData& io, Clay_RenderCommand* command) override;
+        virtual std::optional<uint64_t> content_hash() const override;
     private:
+        void load_svg(UpdateInputData& io, std::string_view newSvgPathView);
+
         bool highlighted;
+        std::string svgPath; // Path svgDom was loaded from, so the SVG map is only searched when the path changes
         sk_sp<SkSVGDOM> svgDom;
 };
 
@@ -3,7 +3,7 @@
 
 namespace GUIStuff {
 
-void SelectableButton::update(UpdateInputData& io, bool hasBorders, bool hasBorderPadding, const std::function<void(SelectionHelper&, bool)>& elemUpdate, bool isSelected) {
+void SelectableButton::update(UpdateInputData& io, bool hasBorders, bool hasBorderPadding, FunctionRef<void(SelectionHelper&, bool)> elemUpdate, bool isSelected) {
     if(hasBorders) {
         SkColor4f borderColor;
         if(selection.held)
@@ -0,0 +1,668 @@
+#include "TextBox.hpp"
+#include "include/core/SkFontMetrics.h"
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <utility>
+
+namespace GUIStuff {
+
+void TextBoxCore::update(UpdateInputData& io, bool newHasData, bool valueChanged, FunctionRef<std::string()> valueText, FunctionRef<std::string(const std::string&)> commit, bool newSingleLine, FunctionRef<void()> elemUpdate) {
+    hasData = newHasData;
+    singleLine = newSingleLine;
+    if(!hasData || valueChanged)
+        refresh_text(false, hasData ? valueText() : displayStr);
+
+    if(textbox)
+        sync_editor_layout(io);
+
+    CLAY({
+        .layout = {
+            .sizing = {.width = CLAY_SIZING_GROW(0), .height = CLAY_SIZING_GROW(0)}
+        },
+        .custom = { .customData = this }
+    }) {
+        selection.update(Clay_Hovered(), io.mouse.leftClick, io.mouse.leftHeld);
+        if(hasData && (selection.selected || !singleLine || !displayIsAscii))
+            create_editor(io);
+        if(textbox) {
+            continue_pending_insert();
+            if(!pendingText.empty())
+                io.frameRequested = true;
+        }
+        CollabTextBox::TextPosition oldCursorPos = cur.pos;
+        if(hasData && selection.selected) {
+            editorReleaseTimer = EDITOR_RELEASE_TIME;
+            // Edits would move the position that pending text is being inserted at, so finish inserting first
+            if(io.key.backspace || io.key.del || io.key.paste || io.key.enter || io.key.cut || !io.textInput.empty()) {
+                finish_pending_insert();
+                invalidate_line_layouts();
+                editorMirrorsDisplay = false;
+            }
+            bool moved = io.key.left || io.key.right || io.key.up || io.key.down || io.key.home;
+            bool movedHeld = false;
+
+            if(io.mouse.leftClick) {
+                Vector2f textSelectPos = io.mouse.pos - bb.pos + scrollOffset;
+                cur.pos = cur.selectionBeginPos = text_position_at(textSelectPos);
+                moved = true;
+            }
+            else if(io.mouse.leftHeld) {
+                Vector2f textSelectPos = io.mouse.pos - bb.pos + scrollOffset;
+                cur.pos = cur.selectionBeginPos = text_position_at(textSelectPos);
+                movedHeld = true;
+            }
+
+            if(io.key.left)
+                cur.pos = cur.selectionBeginPos = textbox->move(io.key.leftCtrl ? CollabTextBox::Movement::kWordLeft : CollabTextBox::Movement::kLeft, cur.selectionBeginPos);
+            if(io.key.right)
+                cur.pos = cur.selectionBeginPos = textbox->move(io.key.leftCtrl ? CollabTextBox::Movement::kWordRight : CollabTextBox::Movement::kRight, cur.selectionBeginPos);
+            if(io.key.up && !singleLine)
+                cur.pos = cur.selectionBeginPos = textbox->move(CollabTextBox::Movement::kUp, cur.selectionBeginPos);
+            if(io.key.down && !singleLine)
+                cur.pos = cur.selectionBeginPos = textbox->move(CollabTextBox::Movement::kDown, cur.selectionBeginPos);
+            if(io.key.home)
+                cur.pos = cur.selectionBeginPos = textbox->move(CollabTextBox::Movement::kHome, cur.selectionBeginPos);
+
+            if(moved && !io.key.leftShift && !movedHeld)
+                cur.selectionEndPos = cur.selectionBeginPos;
+
+            if(io.key.backspace) {
+                if(cur.selectionBeginPos != cur.selectionEndPos)
+                    cur.selectionEndPos = cur.selectionBeginPos = cur.pos = textbox->remove(cur.selectionBeginPos, cur.selectionEndPos);
+                else
+                    cur.selectionEndPos = cur.selectionBeginPos = cur.pos = textbox->remove(cur.pos, textbox->move(CollabTextBox::Movement::kLeft, cur.pos));
+            }
+            if(io.key.del) {
+                if(cur.selectionBeginPos != cur.selectionEndPos)
+                    cur.selectionEndPos = cur.selectionBeginPos = cur.pos = textbox->remove(cur.selectionBeginPos, cur.selectionEndPos);
+                else
+                    cur.selectionEndPos = cur.selectionBeginPos = cur.pos = textbox->remove(cur.pos, textbox->move(CollabTextBox::Movement::kRight, cur.pos));
+            }
+            if(io.key.paste) {
+                if(cur.selectionBeginPos != cur.selectionEndPos)
+                    cur.selectionEndPos = cur.selectionBeginPos = cur.pos = textbox->remove(cur.selectionBeginPos, cur.selectionEndPos);
+                if(singleLine) {
+                    std::string removedNewlines = io.clipboard.textIn;
+                    std::erase(removedNewlines, '\n');
+                    cur.selectionEndPos = cur.selectionBeginPos = cur.pos = insert_text(cur.pos, removedNewlines);
+                }
+                else
+                    cur.selectionEndPos = cur.selectionBeginPos = cur.pos = insert_text(cur.pos, io.clipboard.textIn);
+            }
+            if(io.key.enter) {
+                if(singleLine) {
+                    finish_pending_insert();
+                    refresh_text(true, commit(textbox->get_string()));
+                }
+                else {
+                    if(cur.selectionBeginPos != cur.selectionEndPos)
+                        cur.selectionEndPos = cur.selectionBeginPos = cur.pos = textbox->remove(cur.selectionBeginPos, cur.selectionEndPos);
+                    cur.pos = textbox->insert(cur.pos, "\n");
+                    cur.pos.fParagraphIndex++;
+                    cur.pos.fTextByteIndex = 0;
+                    cur.selectionBeginPos = cur.selectionEndPos = cur.pos;
+                }
+            }
+            if(io.key.copy) {
+                io.clipboard.textOut = textbox->copy(cur.selectionBeginPos, cur.selectionEndPos);
+            }
+            if(io.key.cut) {
+                io.clipboard.textOut = textbox->copy(cur.selectionBeginPos, cur.selectionEndPos);
+                if(cur.selectionBeginPos != cur.selectionEndPos)
+                    cur.selectionEndPos = cur.selectionBeginPos = cur.pos = textbox->remove(cur.selectionBeginPos, cur.selectionEndPos);
+            }
+            if(io.key.selectAll) {
+                cur.selectionEndPos.fParagraphIndex = textbox->lineCount() == 0 ? 0 : textbox->lineCount() - 1;
+                cur.selectionEndPos.fTextByteIndex = textbox->line(cur.selectionEndPos.fParagraphIndex).size();
+                cur.pos = cur.selectionEndPos;
+                cur.selectionBeginPos.fTextByteIndex = 0;
+                cur.selectionBeginPos.fParagraphIndex = 0;
+            }
+            if(!io.textInput.empty()) {
+                if(cur.selectionBeginPos != cur.selectionEndPos)
+                    cur.selectionEndPos = cur.selectionBeginPos = cur.pos = textbox->remove(cur.selectionBeginPos, cur.selectionEndPos);
+                cur.selectionEndPos = cur.selectionBeginPos = cur.pos = textbox->insert(cur.pos, io.textInput);
+            }
+
+            io.acceptingTextInput = true;
+        }
+        if(hasData && selection.justUnselected && textbox) {
+            finish_pending_insert();
+            refresh_text(true, commit(textbox->get_string()));
+        }
+        if(textbox) {
+            update_large_document_mode();
+            if(largeDocument) {
+                if(Clay_Hovered())
+                    scrollOffset.y() -= io.mouse.scroll.y() * io.deltaTime * 3000.0f;
+                if(cur.pos != oldCursorPos)
+                    followCursor = true;
+            }
+        }
+        if(textbox && singleLine && displayIsAscii && !selection.selected && pendingText.empty()) {
+            // Unfocused single line boxes only need the display string, so drop the editor once it's been unused for a while
+            editorReleaseTimer -= io.deltaTime;
+            if(editorReleaseTimer <= 0.0f)
+                textbox = nullptr;
+        }
+        if(elemUpdate)
+            elemUpdate();
+    }
+}
+
+void TextBoxCore::clay_draw(SkCanvas* canvas, UpdateInputData& io, Clay_RenderCommand* command) {
+    if(!hasData)
+        return;
+
+    bb = get_bb(command);
+
+    canvas->save();
+    SkRect r = SkRect::MakeXYWH(bb.pos.x(), bb.pos.y(), bb.dim.x(), bb.dim.y());
+
+    canvas->drawRect(r, SkPaint(io.theme->backColor2));
+    SkPaint outline(selection.selected ? io.theme->fillColor1 : io.theme->backColor3);
+    outline.setStroke(true);
+    outline.setStrokeWidth(2.0f);
+    canvas->drawRoundRect(r, 2.0f, 2.0f, outline);
+
+    canvas->clipRect(SkRect::MakeXYWH(bb.pos.x(), bb.pos.y(), bb.dim.x(), bb.dim.y()));
+
+    canvas->translate(bb.pos.x(), bb.pos.y());
+
+    if(textbox && largeDocument) {
+        sync_editor_layout(io);
+        paint_visible_lines(canvas, io);
+    }
+    else if(textbox) {
+        sync_editor_layout(io);
+
+        CollabTextBox::Editor::PaintOpts paintOpts;
+        paintOpts.fForegroundColor = io.theme->frontColor1;
+        paintOpts.fBackgroundColor = {0.0f, 0.0f, 0.0f, 0.0f};
+        paintOpts.cursorColor = io.theme->fillColor1;
+        paintOpts.showCursor = selection.selected;
+        paintOpts.cursor = cur;
+
+        textbox->paint(canvas, paintOpts);
+    }
+    else {
+        SkFont f(io.theme->textTypeface, io.theme->fontSize);
+        if(!displayBlob || f != displayBlobFont) {
+            displayBlob = SkTextBlob::MakeFromText(displayStr.c_str(), displayStr.size(), f, SkTextEncoding::kUTF8);
+            displayBlobFont = f;
+        }
+        if(displayBlob) {
+            SkFontMetrics metrics;
+            f.getMetrics(&metrics);
+            canvas->drawTextBlob(displayBlob, 0.0f, -metrics.fAscent, SkPaint(io.theme->frontColor1));
+        }
+    }
+
+    canvas->restore();
+}
+
+std::optional<uint64_t> TextBoxCore::content_hash() const {
+    uint64_t h = 0;
+    hash_combine(h, hasData);
+    hash_combine(h, selection.selected);
+    if(!textbox) {
+        hash_combine(h, std::string_view(displayStr));
+        return h;
+    }
+    // The editor's text is only changed through this class, and every change bumps editorRevision
+    hash_combine(h, editorRevision);
+    for(const CollabTextBox::TextPosition* p : {&cur.pos, &cur.selectionBeginPos, &cur.selectionEndPos}) {
+        hash_combine(h, p->fParagraphIndex);
+        hash_combine(h, p->fTextByteIndex);
+    }
+    hash_combine(h, largeDocument);
+    hash_combine(h, scrollOffset.x());
+    hash_combine(h, scrollOffset.y());
+    hash_combine(h, pendingNewlines);
+    return h;
+}
+
+void TextBoxCore::refresh_text(bool reallyForce, std::string newDisplayStr) {
+    displayBlob = nullptr;
+    std::string oldDisplayStr = std::exchange(displayStr, std::move(newDisplayStr));
+    invalidate_line_layouts();
+    displayIsAscii = std::all_of(displayStr.begin(), displayStr.end(), [](char c) { return static_cast<unsigned char>(c) < 0x80; });
+    // Values changed from outside the box only replace the part of the text that changed, so the editor keeps its layout and cursor
+    if(textbox && hasData && !reallyForce) {
+        sync_editor_text(oldDisplayStr, displayStr);
+        return;
+    }
+    scrollOffset = {0.0f, 0.0f};
+    if(textbox)
+        reset_editor_text();
+    else
+        cur = CollabTextBox::Cursor();
+}
+
+void TextBoxCore::reset_editor_text() {
+    // Text that hasn't been inserted yet belongs to the old editor, so it's dropped rather than finished
+    clear_pending_insert();
+    *textbox = CollabTextBox::Editor();
+    editorLayoutSynced = false;
+    invalidate_line_layouts();
+    cur = CollabTextBox::Cursor();
+    editorMirrorsDisplay = hasData;
+    if(hasData) {
+        cur.pos = cur.selectionBeginPos = cur.selectionEndPos = insert_text({0, 0}, displayStr);
+        pendingDisplayOffset = 0;
+    }
+}
+
+CollabTextBox::TextPosition TextBoxCore::byte_offset_to_text_pos(std::string_view str, size_t offset) {
+    std::string_view before = str.substr(0, offset);
+    size_t lastNewline = before.rfind('\n');
+    CollabTextBox::TextPosition toRet;
+    toRet.fParagraphIndex = std::count(before.begin(), before.end(), '\n');
+    toRet.fTextByteIndex = lastNewline == std::string_view::npos ? offset : offset - lastNewline - 1;
+    return toRet;
+}
+
+size_t TextBoxCore::text_pos_to_byte_offset(std::string_view str, const CollabTextBox::TextPosition& pos) {
+    size_t lineStart = 0;
+    for(size_t i = 0; i < pos.fParagraphIndex; i++) {
+        size_t newline = str.find('\n', lineStart);
+        if(newline == std::string_view::npos)
+            return str.size();
+        lineStart = newline + 1;
+    }
+    return std::min(lineStart + pos.fTextByteIndex, str.size());
+}
+
+void TextBoxCore::sync_editor_text(std::string_view oldStr, std::string_view newStr) {
+    // The editor holds oldStr unless it was edited, so the editor's text only has to be copied out after edits
+    std::string editedStr;
+    if(!editorMirrorsDisplay) {
+        finish_pending_insert();
+        editedStr = textbox->get_string();
+        oldStr = editedStr;
+    }
+    auto is_continuation_byte = [](char c) {
+        return (static_cast<unsigned char>(c) & 0xC0) == 0x80;
+    };
+
+    size_t prefix = std::mismatch(oldStr.begin(), oldStr.end(), newStr.begin(), newStr.end()).first - oldStr.begin();
+    if(prefix == oldStr.size() && prefix == newStr.size())
+        return;
+    size_t maxSuffix = std::min(oldStr.size(), newStr.size()) - prefix;
+    size_t suffix = 0;
+    while(suffix < maxSuffix && oldStr[oldStr.size() - 1 - suffix] == newStr[newStr.size() - 1 - suffix])
+        suffix++;
+    // Don't split UTF-8 sequences
+    while(prefix > 0 && ((prefix < oldStr.size() && is_continuation_byte(oldStr[prefix])) || (prefix < newStr.size() && is_continuation_byte(newStr[prefix]))))
+        prefix--;
+    while(suffix > 0 && is_continuation_byte(oldStr[oldStr.size() - suffix]))
+        suffix--;
+
+    size_t oldChangeEnd = oldStr.size() - suffix;
+    size_t newChangeEnd = newStr.size() - suffix;
+
+    if(!pendingText.empty()) {
+        // The editor is still being given oldStr[pendingDisplayOffset, pendingEnd), and already has the text around it.
+        // If the change is inside the part it doesn't have yet, only the text still to be inserted changes
+        size_t insertedEnd = pendingDisplayOffset + pendingTextOffset;
+        size_t pendingEnd = pendingDisplayOffset + pendingText.size();
+        if(insertedEnd <= prefix && pendingEnd >= oldChangeEnd) {
+            std::string_view newPending = newStr.substr(insertedEnd, pendingEnd - oldChangeEnd + newChangeEnd - insertedEnd);
+            pendingText = newPending;
+            pendingTextOffset = 0;
+            pendingDisplayOffset = insertedEnd;
+            pendingNewlines = std::count(newPending.begin(), newPending.end(), '\n');
+            if(pendingText.empty()) {
+                clear_pending_insert();
+                cur.pos = cur.selectionBeginPos = cur.selectionEndPos = pendingInsertPos;
+            }
+        }
+        else
+            reset_editor_text();
+        return;
+    }
+
+    auto remap = [&](const CollabTextBox::TextPosition& pos) {
+        size_t offset = text_pos_to_byte_offset(oldStr, pos);
+        if(offset > prefix)
+            offset = offset >= oldChangeEnd ? offset - oldChangeEnd + newChangeEnd : newChangeEnd;
+        return byte_offset_to_text_pos(newStr, offset);
+    };
+    CollabTextBox::Cursor newCur = cur;
+    newCur.pos = remap(cur.pos);
+    newCur.selectionBeginPos = remap(cur.selectionBeginPos);
+    newCur.selectionEndPos = remap(cur.selectionEndPos);
+
+    CollabTextBox::TextPosition changeStart = byte_offset_to_text_pos(oldStr, prefix);
+    if(oldChangeEnd != prefix)
+        textbox->remove(changeStart, byte_offset_to_text_pos(oldStr, oldChangeEnd));
+    invalidate_line_layouts();
+    editorMirrorsDisplay = true;
+    if(newChangeEnd - prefix > INSERT_CHUNK_BYTES) {
+        // Inserted over several frames like a paste, so the cursor ends up after the inserted text
+        cur.pos = cur.selectionBeginPos = cur.selectionEndPos = insert_text(changeStart, newStr.substr(prefix, newChangeEnd - prefix));
+        pendingDisplayOffset = prefix;
+        return;
+    }
+    if(newChangeEnd != prefix)
+        textbox->insert(changeStart, std::string(newStr.substr(prefix, newChangeEnd - prefix)));
+    cur = newCur;
+}
+
+void TextBoxCore::create_editor(UpdateInputData& io) {
+    if(textbox)
+        return;
+    textbox = std::make_unique<CollabTextBox::Editor>();
+    editorLayoutSynced = false;
+    invalidate_line_layouts();
+    sync_editor_layout(io);
+    cur = CollabTextBox::Cursor();
+    cur.pos = cur.selectionBeginPos = cur.selectionEndPos = insert_text({0, 0}, displayStr);
+    pendingDisplayOffset = 0;
+    editorMirrorsDisplay = true;
+}
+
+CollabTextBox::TextPosition TextBoxCore::insert_text(CollabTextBox::TextPosition pos, std::string_view text) {
+    finish_pending_insert();
+    if(text.size() <= INSERT_CHUNK_BYTES) {
+        invalidate_line_layouts();
+        return textbox->insert(pos, std::string(text));
+    }
+    pendingText = text;
+    pendingTextOffset = 0;
+    pendingInsertPos = pos;
+    pendingNewlines = std::count(text.begin(), text.end(), '\n');
+    insert_next_chunk();
+    return pos;
+}
+
+void TextBoxCore::insert_next_chunk() {
+    std::string_view remaining = std::string_view(pendingText).substr(pendingTextOffset);
+    size_t chunkSize = remaining.size();
+    if(chunkSize > INSERT_CHUNK_BYTES) {
+        // End chunks after a newline if possible, otherwise on a UTF-8 character boundary
+        size_t newline = remaining.rfind('\n', INSERT_CHUNK_BYTES - 1);
+        if(newline != std::string_view::npos)
+            chunkSize = newline + 1;
+        else {
+            chunkSize = INSERT_CHUNK_BYTES;
+            while(chunkSize > 1 && (static_cast<unsigned char>(remaining[chunkSize]) & 0xC0) == 0x80)
+                chunkSize--;
+        }
+    }
+    std::string_view chunk = remaining.substr(0, chunkSize);
+    pendingInsertPos = textbox->insert(pendingInsertPos, std::string(chunk));
+    invalidate_line_layouts();
+    pendingNewlines -= std::count(chunk.begin(), chunk.end(), '\n');
+    pendingTextOffset += chunkSize;
+    if(pendingTextOffset >= pendingText.size()) {
+        clear_pending_insert();
+        cur.pos = cur.selectionBeginPos = cur.selectionEndPos = pendingInsertPos;
+        followCursor = true;
+    }
+}
+
+void TextBoxCore::continue_pending_insert() {
+    auto start = std::chrono::steady_clock::now();
+    while(!pendingText.empty() && std::chrono::duration<float>(std::chrono::steady_clock::now() - start).count() < INSERT_TIME_BUDGET)
+        insert_next_chunk();
+}
+
+void TextBoxCore::finish_pending_insert() {
+    while(!pendingText.empty())
+        insert_next_chunk();
+}
+
+void TextBoxCore::clear_pending_insert() {
+    pendingText.clear();
+    pendingText.shrink_to_fit();
+    pendingTextOffset = 0;
+    pendingNewlines = 0;
+}
+
+void TextBoxCore::sync_editor_layout(UpdateInputData& io) {
+    SkFont f(io.theme->textTypeface, io.theme->fontSize);
+    // Large documents aren't wrapped, so that line i is always at i * line height and can be found without laying out the lines above it
+    float width = (singleLine || largeDocument) ? 99999999 : bb.dim.x();
+    bool changed = false;
+    if(!editorLayoutSynced || f != editorFont) {
+        textbox->setFont(f);
+        editorFont = f;
+        changed = true;
+        layoutFonts.clear();
+        invalidate_line_layouts();
+    }
+    if(!editorLayoutSynced || io.textFontMgr != editorFontMgr) {
+        textbox->setFontMgr(io.textFontMgr);
+        editorFontMgr = io.textFontMgr;
+        changed = true;
+        layoutFonts.clear();
+        invalidate_line_layouts();
+    }
+    if(!editorLayoutSynced || width != editorWidth) {
+        textbox->setWidth(width);
+        editorWidth = width;
+        changed = true;
+    }
+    editorLayoutSynced = true;
+    if(changed)
+        io.textBoxRelayoutCount++;
+}
+
+std::string_view TextBoxCore::editor_line(size_t i) const {
+    // line(i) returns the paragraph's UTF-8 text as a string-like object (see the selectAll handling, which uses its size())
+    auto l = textbox->line(i);
+    return std::string_view(l.data(), l.size());
+}
+
+void TextBoxCore::update_large_document_mode() {
+    size_t lineCount = textbox->lineCount();
+    largeDocument = singleLine ? (lineCount != 0 && textbox->line(0).size() >= LARGE_DOCUMENT_LINE_BYTES) : (lineCount >= LARGE_DOCUMENT_LINE_COUNT);
+    if(!largeDocument)
+        scrollOffset = {0.0f, 0.0f};
+}
+
+bool TextBoxCore::text_pos_less(const CollabTextBox::TextPosition& a, const CollabTextBox::TextPosition& b) {
+    return a.fParagraphIndex < b.fParagraphIndex || (a.fParagraphIndex == b.fParagraphIndex && a.fTextByteIndex < b.fTextByteIndex);
+}
+
+void TextBoxCore::invalidate_line_layouts() {
+    lineLayouts.clear();
+    editorRevision++;
+}
+
+uint8_t TextBoxCore::fallback_font_index(SkUnichar c) {
+    if(layoutFonts.empty())
+        layoutFonts.emplace_back(editorFont);
+    for(size_t i = 1; i < layoutFonts.size(); i++) {
+        if(layoutFonts[i].unicharToGlyph(c) != 0)
+            return i;
+    }
+    if(!editorFontMgr || layoutFonts.size() > std::numeric_limits<uint8_t>::max())
+        return 0;
+    SkFontStyle style = editorFont.getTypeface() ? editorFont.getTypeface()->fontStyle() : SkFontStyle();
+    sk_sp<SkTypeface> fallback = editorFontMgr->matchFamilyStyleCharacter(nullptr, style, nullptr, 0, c);
+    if(!fallback)
+        return 0;
+    SkFont f = editorFont;
+    f.setTypeface(std::move(fallback));
+    layoutFonts.emplace_back(f);
+    return layoutFonts.size() - 1;
+}
+
+const TextBoxCore::LineLayout& TextBoxCore::line_layout(size_t i) {
+    auto it = lineLayouts.find(i);
+    if(it != lineLayouts.end())
+        return it->second;
+    if(lineLayouts.size() >= LINE_LAYOUT_CACHE_SIZE)
+        lineLayouts.clear();
+    if(layoutFonts.empty())
+        layoutFonts.emplace_back(editorFont);
+
+    LineLayout& layout = lineLayouts[i];
+    std::string_view line = editor_line(i);
+    std::vector<SkUnichar> unichars;
+    for(size_t b = 0; b < line.size();) {
+        layout.byteOffsets.emplace_back(b);
+        unsigned char lead = line[b];
+        size_t len = lead < 0x80 ? 1 : (lead >> 5) == 0x6 ? 2 : (lead >> 4) == 0xE ? 3 : (lead >> 3) == 0x1E ? 4 : 0;
+        SkUnichar c = len <= 1 ? lead : lead & (0x7F >> len);
+        for(size_t k = 1; k < len && len != 0; k++) {
+            if(b + k >= line.size() || (static_cast<unsigned char>(line[b + k]) & 0xC0) != 0x80)
+                len = 0;
+            else
+                c = (c << 6) | (static_cast<unsigned char>(line[b + k]) & 0x3F);
+        }
+        // Invalid bytes are shown as replacement characters, one per byte
+        if(len == 0) {
+            len = 1;
+            c = 0xFFFD;
+        }
+        unichars.emplace_back(c);
+        b += len;
+    }
+    layout.byteOffsets.emplace_back(line.size());
+
+    size_t count = unichars.size();
+    layout.glyphs.resize(count);
+    layout.fontIndices.assign(count, 0);
+    editorFont.unicharsToGlyphs(unichars.data(), count, layout.glyphs.data());
+    for(size_t g = 0; g < count; g++) {
+        if(layout.glyphs[g] == 0 && unichars[g] >= 0x20) {
+            uint8_t fontIndex = fallback_font_index(unichars[g]);
+            if(fontIndex != 0) {
+                layout.fontIndices[g] = fontIndex;
+                layout.glyphs[g] = layoutFonts[fontIndex].unicharToGlyph(unichars[g]);
+            }
+        }
+    }
+
+    std::vector<SkScalar> widths(count);
+    for(size_t runStart = 0; runStart < count;) {
+        size_t runEnd = runStart + 1;
+        while(runEnd < count && layout.fontIndices[runEnd] == layout.fontIndices[runStart])
+            runEnd++;
+        layoutFonts[layout.fontIndices[runStart]].getWidths(layout.glyphs.data() + runStart, runEnd - runStart, widths.data() + runStart);
+        runStart = runEnd;
+    }
+    layout.xPos.resize(count + 1);
+    layout.xPos[0] = 0.0f;
+    for(size_t g = 0; g < count; g++)
+        layout.xPos[g + 1] = layout.xPos[g] + widths[g];
+    return layout;
+}
+
+float TextBoxCore::line_x(size_t i, size_t byteIndex) {
+    const LineLayout& layout = line_layout(i);
+    size_t g = std::upper_bound(layout.byteOffsets.begin(), layout.byteOffsets.end(), byteIndex) - layout.byteOffsets.begin();
+    return layout.xPos[g == 0 ? 0 : g - 1];
+}
+
+CollabTextBox::TextPosition TextBoxCore::large_document_position(const Vector2f& p) {
+    size_t lineCount = textbox->lineCount();
+    CollabTextBox::TextPosition toRet;
+    toRet.fParagraphIndex = 0;
+    toRet.fTextByteIndex = 0;
+    if(lineCount == 0)
+        return toRet;
+    float lineHeight = editorFont.getSpacing();
+    size_t i = std::min(static_cast<size_t>(std::max(p.y() / lineHeight, 0.0f)), lineCount - 1);
+    const LineLayout& layout = line_layout(i);
+    // Pick whichever glyph edge is closest to p
+    size_t g = std::upper_bound(layout.xPos.begin(), layout.xPos.end(), p.x()) - layout.xPos.begin();
+    if(g == layout.xPos.size())
+        g--;
+    else if(g > 0 && p.x() - layout.xPos[g - 1] < layout.xPos[g] - p.x())
+        g--;
+    toRet.fParagraphIndex = i;
+    toRet.fTextByteIndex = layout.byteOffsets[g];
+    return toRet;
+}
+
+CollabTextBox::TextPosition TextBoxCore::text_position_at(const Vector2f& p) {
+    if(largeDocument)
+        return large_document_position(p);
+    return textbox->getPosition(convert_vec2<SkIPoint>(p.cast<int32_t>()));
+}
+
+void TextBoxCore::paint_visible_lines(SkCanvas* canvas, UpdateInputData& io) {
+    const SkFont& f = editorFont;
+    SkFontMetrics metrics;
+    f.getMetrics(&metrics);
+    float lineHeight = f.getSpacing();
+    size_t lineCount = textbox->lineCount();
+
+    if(followCursor && cur.pos.fParagraphIndex < lineCount) {
+        float cursorX = line_x(cur.pos.fParagraphIndex, cur.pos.fTextByteIndex);
+        float cursorY = cur.pos.fParagraphIndex * lineHeight;
+        scrollOffset.x() = std::min(std::max(scrollOffset.x(), cursorX - bb.dim.x() + 2.0f), cursorX);
+        scrollOffset.y() = std::min(std::max(scrollOffset.y(), cursorY + lineHeight - bb.dim.y()), cursorY);
+        followCursor = false;
+    }
+    // Text still waiting to be inserted is counted by its newlines, so the scroll range is close to final while it loads
+    float contentHeight = (lineCount + pendingNewlines) * lineHeight;
+    scrollOffset.x() = std::max(scrollOffset.x(), 0.0f);
+    scrollOffset.y() = std::clamp(scrollOffset.y(), 0.0f, std::max(contentHeight - bb.dim.y(), 0.0f));
+
+    size_t firstLine = static_cast<size_t>(scrollOffset.y() / lineHeight);
+    size_t endLine = std::min(lineCount, static_cast<size_t>((scrollOffset.y() + bb.dim.y()) / lineHeight) + 1);
+
+    CollabTextBox::TextPosition selBegin = cur.selectionBeginPos;
+    CollabTextBox::TextPosition selEnd = cur.selectionEndPos;
+    if(text_pos_less(selEnd, selBegin))
+        std::swap(selBegin, selEnd);
+    SkPaint selectionPaint(SkColor4f{io.theme->fillColor1.fR, io.theme->fillColor1.fG, io.theme->fillColor1.fB, 0.4f});
+    SkPaint textPaint(io.theme->frontColor1);
+
+    for(size_t i = firstLine; i < endLine; i++) {
+        const LineLayout& layout = line_layout(i);
+        float y = i * lineHeight - scrollOffset.y();
+
+        if(selection.selected && selBegin != selEnd && i >= selBegin.fParagraphIndex && i <= selEnd.fParagraphIndex) {
+            float x1 = i == selBegin.fParagraphIndex ? line_x(i, selBegin.fTextByteIndex) : 0.0f;
+            float x2 = i == selEnd.fParagraphIndex ? line_x(i, selEnd.fTextByteIndex) : layout.xPos.back();
+            canvas->drawRect(SkRect::MakeLTRB(x1 - scrollOffset.x(), y, x2 - scrollOffset.x(), y + lineHeight), selectionPaint);
+        }
+
+        if(layout.glyphs.empty())
+            continue;
+
+        // Glyphs are drawn from one glyph before the left edge to the last glyph that starts before the right edge
+        auto glyphXEnd = layout.xPos.end() - 1;
+        size_t firstGlyph = std::upper_bound(layout.xPos.begin(), glyphXEnd, scrollOffset.x()) - layout.xPos.begin();
+        firstGlyph = firstGlyph == 0 ? 0 : firstGlyph - 1;
+        size_t endGlyph = std::upper_bound(layout.xPos.begin() + firstGlyph, glyphXEnd, scrollOffset.x() + bb.dim.x()) - layout.xPos.begin();
+        if(firstGlyph >= endGlyph)
+            continue;
+
+        // One run per stretch of glyphs from the same font
+        SkTextBlobBuilder builder;
+        for(size_t runStart = firstGlyph; runStart < endGlyph;) {
+            size_t runEnd = runStart + 1;
+            while(runEnd < endGlyph && layout.fontIndices[runEnd] == layout.fontIndices[runStart])
+                runEnd++;
+            const SkTextBlobBuilder::RunBuffer& run = builder.allocRunPosH(layoutFonts[layout.fontIndices[runStart]], runEnd - runStart, y - metrics.fAscent);
+            for(size_t g = runStart; g < runEnd; g++) {
+                run.glyphs[g - runStart] = layout.glyphs[g];
+                run.pos[g - runStart] = layout.xPos[g] - scrollOffset.x();
+            }
+            runStart = runEnd;
+        }
+        canvas->drawTextBlob(builder.make(), 0.0f, 0.0f, textPaint);
+    }
+
+    if(selection.selected && cur.pos.fParagraphIndex >= firstLine && cur.pos.fParagraphIndex < endLine) {
+        float cursorX = line_x(cur.pos.fParagraphIndex, cur.pos.fTextByteIndex) - scrollOffset.x();
+        float cursorY = cur.pos.fParagraphIndex * lineHeight - scrollOffset.y();
+        canvas->drawRect(SkRect::MakeXYWH(cursorX, cursorY, 2.0f, lineHeight), SkPaint(io.theme->fillColor1));
+    }
+
+    if(contentHeight > bb.dim.y()) {
+        float scrollerHeight = std::max((bb.dim.y() / contentHeight) * bb.dim.y(), 10.0f);
+        float scrollerY = (scrollOffset.y() / (contentHeight - bb.dim.y())) * (bb.dim.y() - scrollerHeight);
+        canvas->drawRoundRect(SkRect::MakeXYWH(bb.dim.x() - 6.0f, scrollerY, 4.0f, scrollerHeight), 2.0f, 2.0f, SkPaint(io.theme->backColor3));
+    }
+}
+
+}
@@ -1,195 +1,135 @@
 #pragma once
 #include "Element.hpp"
+#include "TextCodecs.hpp"
 #include "../../CollabTextBox/CollabTextBox.hpp"
+#include "include/core/SkTextBlob.h"
 
 namespace GUIStuff {
 
-template <typename T> class TextBox : public Element {
+// Editing and drawing for text boxes, compiled once. TextBox<T, Codec> only converts the bound value to and from text
+class TextBoxCore : public Element {
     public:
-        void update(UpdateInputData& io, T* newData, const std::function<std::optional<T>(const std::string&)>& newFromStr, const std::function<std::string(const T&)> newToStr, bool newSingleLine, const std::function<void()>& elemUpdate) {
-            data = newData;
-            fromStr = newFromStr;
-            toStr = newToStr;
-            singleLine = newSingleLine;
-            force_update_textbox(false);
+        // valueText is called for the text of the bound value when it changed. commit is called with the editor's text when editing finishes,
+        // and returns the text of the value after it was assigned. Neither is stored
+        void update(UpdateInputData& io, bool newHasData, bool valueChanged, FunctionRef<std::string()> valueText, FunctionRef<std::string(const std::string&)> commit, bool newSingleLine, FunctionRef<void()> elemUpdate);
+        virtual void clay_draw(SkCanvas* canvas, UpdateInputData& io, Clay_RenderCommand* command) override;
+        virtual std::optional<uint64_t> content_hash() const override;
+        SelectionHelper selection;
+    private:
+        void refresh_text(bool reallyForce, std::string newDisplayStr);
+        static CollabTextBox::TextPosition byte_offset_to_text_pos(std::string_view str, size_t offset);
+        static size_t text_pos_to_byte_offset(std::string_view str, const CollabTextBox::TextPosition& pos);
+        // oldStr is displayStr before the change
+        void sync_editor_text(std::string_view oldStr, std::string_view newStr);
+        void reset_editor_text();
+        void create_editor(UpdateInputData& io);
+
+        // Large text is inserted over several frames, INSERT_CHUNK_BYTES at a time for up to INSERT_TIME_BUDGET seconds per frame,
+        // so that the editor never lays out more than a frame's worth of text at once. Inserting starts at pos, so the
+        // text around pos is available first. The cursor is moved to the end of the text once it's all inserted
+        CollabTextBox::TextPosition insert_text(CollabTextBox::TextPosition pos, std::string_view text);
+        void insert_next_chunk();
+        void continue_pending_insert();
+        void finish_pending_insert();
+        void clear_pending_insert();
+
+        // The editor may lay out its paragraphs again whenever these are set, so only set them when they change
+        void sync_editor_layout(UpdateInputData& io);
+        std::string_view editor_line(size_t i) const;
+        void update_large_document_mode();
+        static bool text_pos_less(const CollabTextBox::TextPosition& a, const CollabTextBox::TextPosition& b);
+
+        // Paints only the lines, and the glyphs within those lines, that are inside the bounding box. Expects the canvas to be translated to bb.pos
+        void paint_visible_lines(SkCanvas* canvas, UpdateInputData& io);
+
+        // Glyphs of a line in large document mode, with a fallback font picked for each character the editor font doesn't have.
+        // Drawing, clicking and the cursor all use these positions, so they agree with each other. Text isn't shaped
+        struct LineLayout {
+            std::vector<SkGlyphID> glyphs;
+            std::vector<uint8_t> fontIndices; // Into layoutFonts
+            std::vector<SkScalar> xPos; // One more than glyphs, the last is the line's width
+            std::vector<uint32_t> byteOffsets; // One more than glyphs, the last is the line's size
+        };
+        const LineLayout& line_layout(size_t i);
+        void invalidate_line_layouts(); // Call whenever the editor's text or font changes. Also counts the changes in editorRevision
+        uint8_t fallback_font_index(SkUnichar c);
+        float line_x(size_t i, size_t byteIndex);
+        CollabTextBox::TextPosition large_document_position(const Vector2f& p); // p is relative to the top left of the text
+        CollabTextBox::TextPosition text_position_at(const Vector2f& p);
+
+        static constexpr float EDITOR_RELEASE_TIME = 5.0f;
+        static constexpr size_t INSERT_CHUNK_BYTES = 65536;
+        static constexpr float INSERT_TIME_BUDGET = 0.004f;
+        // Boxes past these sizes only paint what's inside their bounding box, and scroll instead of showing all of their text
+        static constexpr size_t LARGE_DOCUMENT_LINE_COUNT = 1000;
+        static constexpr size_t LARGE_DOCUMENT_LINE_BYTES = 4096;
+        static constexpr size_t LINE_LAYOUT_CACHE_SIZE = 256;
+
+        bool hasData = false;
+
+        bool singleLine = true;
 
-            textbox.setFont(SkFont(io.theme->textTypeface, io.theme->fontSize));
-            textbox.setFontMgr(io.textFontMgr);
+        // Only exists while the box is being edited (and for EDITOR_RELEASE_TIME seconds after), or if the box is multiline
+        std::unique_ptr<CollabTextBox::Editor> textbox;
+        CollabTextBox::Cursor cur;
+        float editorReleaseTimer = 0.0f;
+
+        std::string pendingText; // Text that insert_text hasn't given to the editor yet, starting at pendingTextOffset
+        size_t pendingTextOffset = 0;
+        size_t pendingNewlines = 0;
+        CollabTextBox::TextPosition pendingInsertPos;
+        size_t pendingDisplayOffset = 0; // Where pendingText starts in displayStr, if editorMirrorsDisplay
+        // The editor holds displayStr, apart from the pending text, until the user edits it
+        bool editorMirrorsDisplay = false;
+
+        bool largeDocument = false;
+        bool followCursor = false;
+        Vector2f scrollOffset{0.0f, 0.0f};
+        std::unordered_map<size_t, LineLayout> lineLayouts;
+        uint64_t editorRevision = 0;
+        std::vector<SkFont> layoutFonts; // The editor font, then fallback fonts
+
+        // What was last passed to the editor
+        bool editorLayoutSynced = false;
+        SkFont editorFont;
+        sk_sp<SkFontMgr> editorFontMgr;
+        float editorWidth = 0.0f;
+
+        std::string displayStr;
+        // The display blob is drawn with the theme's typeface alone, without fallback fonts or shaping, so boxes with
+        // any other text keep their editor, which lays out with io.textFontMgr
+        bool displayIsAscii = true;
+        sk_sp<SkTextBlob> displayBlob;
+        SkFont displayBlobFont;
+
+        ElemBoundingBox bb;
+};
 
-            CLAY({
-                .layout = {
-                    .sizing = {.width = CLAY_SIZING_GROW(0), .height = CLAY_SIZING_GROW(0)}
+// Codec converts between T and text, see TextCodecs.hpp
+template <typename T, typename Codec> class TextBox : public TextBoxCore {
+    public:
+        // codec is only used during this function, so it isn't stored
+        void update(UpdateInputData& io, T* newData, const Codec& codec, bool newSingleLine, FunctionRef<void()> elemUpdate) {
+            data = newData;
+            TextBoxCore::update(io, data != nullptr, data && (!oldDataSet || !(*data == oldData)),
+                [&]() {
+                    oldData = *data;
+                    oldDataSet = true;
+                    return codec.to_str(*data);
                 },
-                .custom = { .customData = this }
-            }) {
-                selection.update(Clay_Hovered(), io.mouse.leftClick, io.mouse.leftHeld);
-                if(data && selection.selected) {
-                    bool moved = io.key.left || io.key.right || io.key.up || io.key.down || io.key.home;
-                    bool movedHeld = false;
-
-                    if(io.mouse.leftClick) {
-                        Vector2f textSelectPos = io.mouse.pos - bb.pos;
-                        SkIPoint p = convert_vec2<SkIPoint>(textSelectPos.cast<int32_t>());
-                        cur.pos = cur.selectionBeginPos = textbox.getPosition(p);
-                        moved = true;
-                    }
-                    else if(io.mouse.leftHeld) {
-                        Vector2f textSelectPos = io.mouse.pos - bb.pos;
-                        SkIPoint p = convert_vec2<SkIPoint>(textSelectPos.cast<int32_t>());
-                        cur.pos = cur.selectionBeginPos = textbox.getPosition(p);
-                        movedHeld = true;
-                    }
-
-                    if(io.key.left)
-                        cur.pos = cur.selectionBeginPos = textbox.move(io.key.leftCtrl ? CollabTextBox::Movement::kWordLeft : CollabTextBox::Movement::kLeft, cur.selectionBeginPos);
-                    if(io.key.right)
-                        cur.pos = cur.selectionBeginPos = textbox.move(io.key.leftCtrl ? CollabTextBox::Movement::kWordRight : CollabTextBox::Movement::kRight, cur.selectionBeginPos);
-                    if(io.key.up && !singleLine)
-                        cur.pos = cur.selectionBeginPos = textbox.move(CollabTextBox::Movement::kUp, cur.selectionBeginPos);
-                    if(io.key.down && !singleLine)
-                        cur.pos = cur.selectionBeginPos = textbox.move(CollabTextBox::Movement::kDown, cur.selectionBeginPos);
-                    if(io.key.home)
-                        cur.pos = cur.selectionBeginPos = textbox.move(CollabTextBox::Movement::kHome, cur.selectionBeginPos);
-
-                    if(moved && !io.key.leftShift && !movedHeld)
-                        cur.selectionEndPos = cur.selectionBeginPos;
-
-                    if(io.key.backspace) {
-                        if(cur.selectionBeginPos != cur.selectionEndPos)
-                            cur.selectionEndPos = cur.selectionBeginPos = cur.pos = textbox.remove(cur.selectionBeginPos, cur.selectionEndPos);
-                        else
-                            cur.selectionEndPos = cur.selectionBeginPos = cur.pos = textbox.remove(cur.pos, textbox.move(CollabTextBox::Movement::kLeft, cur.pos));
-                    }
-                    if(io.key.del) {
-                        if(cur.selectionBeginPos != cur.selectionEndPos)
-                            cur.selectionEndPos = cur.selectionBeginPos = cur.pos = textbox.remove(cur.selectionBeginPos, cur.selectionEndPos);
-                        else
-                            cur.selectionEndPos = cur.selectionBeginPos = cur.pos = textbox.remove(cur.pos, textbox.move(CollabTextBox::Movement::kRight, cur.pos));
-                    }
-                    if(io.key.paste) {
-                        if(cur.selectionBeginPos != cur.selectionEndPos)
-                            cur.selectionEndPos = cur.selectionBeginPos = cur.pos = textbox.remove(cur.selectionBeginPos, cur.selectionEndPos);
-                        if(singleLine) {
-                            std::string removedNewlines = io.clipboard.textIn;
-                            std::erase(removedNewlines, '\n');
-                            cur.selectionEndPos = cur.selectionBeginPos = cur.pos = textbox.insert(cur.pos, removedNewlines);
-                        }
-                        else
-                            cur.selectionEndPos = cur.selectionBeginPos = cur.pos = textbox.insert(cur.pos, io.clipboard.textIn);
-                    }
-                    if(io.key.enter) {
-                        if(singleLine) {
-                            std::optional<T> dataToAssign = fromStr(textbox.get_string());
-                            if(dataToAssign)
-                                *data = dataToAssign.value();
-                            force_update_textbox(true);
-                        }
-                        else {
-                            if(cur.selectionBeginPos != cur.selectionEndPos)
-                                cur.selectionEndPos = cur.selectionBeginPos = cur.pos = textbox.remove(cur.selectionBeginPos, cur.selectionEndPos);
-                            cur.pos = textbox.insert(cur.pos, "\n");
-                            cur.pos.fParagraphIndex++;
-                            cur.pos.fTextByteIndex = 0;
-                            cur.selectionBeginPos = cur.selectionEndPos = cur.pos;
-                        }
-                    }
-                    if(io.key.copy) {
-                        io.clipboard.textOut = textbox.copy(cur.selectionBeginPos, cur.selectionEndPos);
-                    }
-                    if(io.key.cut) {
-                        io.clipboard.textOut = textbox.copy(cur.selectionBeginPos, cur.selectionEndPos);
-                        if(cur.selectionBeginPos != cur.selectionEndPos)
-                            cur.selectionEndPos = cur.selectionBeginPos = cur.pos = textbox.remove(cur.selectionBeginPos, cur.selectionEndPos);
-                    }
-                    if(io.key.selectAll) {
-                        cur.selectionEndPos.fParagraphIndex = textbox.lineCount() == 0 ? 0 : textbox.lineCount() - 1;
-                        cur.selectionEndPos.fTextByteIndex = textbox.line(cur.selectionEndPos.fParagraphIndex).size();
-                        cur.pos = cur.selectionEndPos;
-                        cur.selectionBeginPos.fTextByteIndex = 0;
-                        cur.selectionBeginPos.fParagraphIndex = 0;
-                    }
-                    if(!io.textInput.empty()) {
-                        if(cur.selectionBeginPos != cur.selectionEndPos)
-                            cur.selectionEndPos = cur.selectionBeginPos = cur.pos = textbox.remove(cur.selectionBeginPos, cur.selectionEndPos);
-                        cur.selectionEndPos = cur.selectionBeginPos = cur.pos = textbox.insert(cur.pos, io.textInput);
-                    }
-
-                    io.acceptingTextInput = true;
-                }
-                if(data && selection.justUnselected) {
-                    std::optional<T> dataToAssign = fromStr(textbox.get_string());
+                [&](const std::string& str) {
+                    std::optional<T> dataToAssign = codec.from_str(str);
                     if(dataToAssign)
                         *data = dataToAssign.value();
-                    force_update_textbox(true);
-                }
-                if(elemUpdate)
-                    elemUpdate();
-            }
+                    oldData = *data;
+                    oldDataSet = true;
+                    return codec.to_str(*data);
+                }, newSingleLine, elemUpdate);
         }
-
-        virtual void clay_draw(SkCanvas* canvas, UpdateInputData& io, Clay_RenderCommand* command) override {
-            if(!data)
-                return;
-
-            bb = get_bb(command);
-
-            canvas->save();
-            SkRect r = SkRect::MakeXYWH(bb.pos.x(), bb.pos.y(), bb.dim.x(), bb.dim.y());
-
-            canvas->drawRect(r, SkPaint(io.theme->backColor2));
-            SkPaint outline(selection.selected ? io.theme->fillColor1 : io.theme->backColor3);
-            outline.setStroke(true);
-            outline.setStrokeWidth(2.0f);
-            canvas->drawRoundRect(r, 2.0f, 2.0f, outline);
-
-            canvas->clipRect(SkRect::MakeXYWH(bb.pos.x(), bb.pos.y(), bb.dim.x(), bb.dim.y()));
-
-            canvas->translate(bb.pos.x(), bb.pos.y());
-
-            textbox.setFont(SkFont(io.theme->textTypeface, io.theme->fontSize));
-            textbox.setFontMgr(io.textFontMgr);
-            textbox.setWidth(singleLine ? 99999999 : bb.dim.x());
-
-            CollabTextBox::Editor::PaintOpts paintOpts;
-            paintOpts.fForegroundColor = io.theme->frontColor1;
-            paintOpts.fBackgroundColor = {0.0f, 0.0f, 0.0f, 0.0f};
-            paintOpts.cursorColor = io.theme->fillColor1;
-            paintOpts.showCursor = selection.selected;
-            paintOpts.cursor = cur;
-
-            textbox.paint(canvas, paintOpts);
-
-            canvas->restore();
-        }
-
-        SelectionHelper selection;
     private:
-        void force_update_textbox(bool reallyForce) {
-            if(data && (*data == oldData) && !reallyForce)
-                return;
-
-            textbox = CollabTextBox::Editor();
-            cur = CollabTextBox::Cursor();
-            if(data) {
-                cur.pos = cur.selectionBeginPos = cur.selectionEndPos = textbox.insert({0, 0}, toStr(*data));
-                oldData = *data;
-            }
-            else {}
-                //oldData = T();
-        }
-
         T* data = nullptr;
         T oldData;
-
-        bool singleLine = true;
-
-        std::function<std::optional<T>(const std::string&)> fromStr;
-        std::function<std::string(const T&)> toStr;
-
-        CollabTextBox::Editor textbox;
-        CollabTextBox::Cursor cur;
-
-        ElemBoundingBox bb;
+        bool oldDataSet = false;
 };
 
 }
@@ -0,0 +1,151 @@
+#pragma once
+#include "Element.hpp"
+#include <charconv>
+#include <filesystem>
+#include <algorithm>
+#include <cmath>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace GUIStuff {
+
+// Codecs convert a TextBox's value to and from its text. TextBox<T, Codec> calls them directly, so they can be inlined.
+// The strings they produce are short enough to fit in std::string's small buffer, so converting doesn't allocate
+
+inline constexpr std::string_view TEXT_CODEC_WHITESPACE = " \t\n\v\f\r";
+
+// Parses like stream extraction did: leading whitespace and a single sign are accepted, and text after the number is ignored.
+// format is passed on to from_chars, ex. 16 for hexadecimal integers
+template <typename T, typename... Format> std::from_chars_result text_codec_parse_number(std::string_view str, T& value, Format... format) {
+    size_t start = str.find_first_not_of(TEXT_CODEC_WHITESPACE);
+    str = start == std::string_view::npos ? std::string_view() : str.substr(start);
+    if(str.size() >= 2 && str[0] == '+' && str[1] != '-')
+        str.remove_prefix(1);
+    return std::from_chars(str.data(), str.data() + str.size(), value, format...);
+}
+
+template <typename T> struct ScalarCodec {
+    T min;
+    T max;
+
+    std::optional<T> from_str(const std::string& str) const {
+        T value;
+        std::from_chars_result r = text_codec_parse_number(str, value);
+        if(r.ec == std::errc::result_out_of_range) {
+            size_t signIndex = str.find_first_not_of(TEXT_CODEC_WHITESPACE);
+            return (signIndex != std::string::npos && str[signIndex] == '-') ? min : max;
+        }
+        if(r.ec != std::errc())
+            return min;
+        // from_chars accepts "nan" and "inf", which stream extraction rejected
+        if constexpr(std::is_floating_point_v<T>) {
+            if(!std::isfinite(value))
+                return min;
+        }
+        return std::clamp(value, min, max);
+    }
+
+    std::string to_str(const T& value) const {
+        char buf[64];
+        std::to_chars_result r;
+        // Keep 8 bit integers from being treated as characters
+        if constexpr(sizeof(T) == 1 && std::is_integral_v<T>)
+            r = std::to_chars(buf, buf + sizeof(buf), static_cast<int>(value));
+        else
+            r = std::to_chars(buf, buf + sizeof(buf), value);
+        return std::string(buf, r.ptr);
+    }
+};
+
+// A float from 0 to 1 shown as an integer from 0 to 255
+struct Color255Codec {
+    std::optional<float> from_str(const std::string& str) const {
+        int value = 0;
+        text_codec_parse_number(str, value);
+        return std::clamp<float>(static_cast<float>(value) / 255.0f, 0.0f, 1.0f);
+    }
+
+    std::string to_str(const float& value) const {
+        char buf[16];
+        std::to_chars_result r = std::to_chars(buf, buf + sizeof(buf), static_cast<int>(value * 255));
+        return std::string(buf, r.ptr);
+    }
+};
+
+// Colors shown as #RRGGBB, or #RRGGBBAA if selectAlpha is set
+template <typename T> struct HexColorCodec {
+    bool selectAlpha;
+
+    std::optional<T> from_str(const std::string& str) const {
+        T def = {0.0f, 0.0f, 0.0f, 1.0f};
+        size_t startIndex = (!str.empty() && str[0] == '#') ? 1 : 0;
+        // Each pair of characters is parsed on its own like stream extraction did, so a pair such as "f " is read as 0x0f
+        for(size_t i = 0; i < (selectAlpha ? 4 : 3); i++) {
+            size_t startingAt = startIndex + i * 2;
+            if(startingAt + 1 >= str.size())
+                break;
+            std::string_view pair = std::string_view(str).substr(startingAt, 2);
+            // Stream extraction read "0x" as a prefix with no digits after it, and failed
+            int byteColor = 0;
+            if(pair == "0x" || pair == "0X" || text_codec_parse_number(pair, byteColor, 16).ec != std::errc())
+                break;
+            def[i] = byteColor / 255.0f;
+        }
+        return def;
+    }
+
+    std::string to_str(const T& color) const {
+        static constexpr char HEX_DIGITS[] = "0123456789abcdef";
+        char buf[9];
+        size_t len = 0;
+        buf[len++] = '#';
+        for(size_t i = 0; i < (selectAlpha ? 4 : 3); i++) {
+            int convertTo255 = static_cast<int>(std::clamp<float>(color[i], 0, 1) * 255);
+            buf[len++] = HEX_DIGITS[convertTo255 >> 4];
+            buf[len++] = HEX_DIGITS[convertTo255 & 0xF];
+        }
+        return std::string(buf, len);
+    }
+};
+
+struct StringCodec {
+    std::optional<std::string> from_str(const std::string& str) const {
+        return str;
+    }
+
+    std::string to_str(const std::string& str) const {
+        return str;
+    }
+};
+
+struct PathCodec {
+    std::filesystem::file_type fileTypeRestriction;
+
+    std::optional<std::filesystem::path> from_str(const std::string& str) const {
+        std::filesystem::path toRet = std::filesystem::path(str);
+        if(fileTypeRestriction != std::filesystem::file_type::none && std::filesystem::status(toRet).type() != fileTypeRestriction)
+            return std::nullopt;
+        return toRet;
+    }
+
+    std::string to_str(const std::filesystem::path& p) const {
+        return p.string();
+    }
+};
+
+// For conversions passed in by the caller, ex. GUIManager::input_generic
+template <typename T> struct FunctionCodec {
+    FunctionRef<std::optional<T>(const std::string&)> fromStr;
+    FunctionRef<std::string(const T&)> toStr;
+
+    std::optional<T> from_str(const std::string& str) const {
+        return fromStr(str);
+    }
+
+    std::string to_str(const T& value) const {
+        return toStr(value);
+    }
+};
+
+}
@@ -0,0 +1,42 @@
+#include "FrameArena.hpp"
+#include <algorithm>
+
+namespace GUIStuff {
+
+FrameArena::FrameArena(size_t initialSize):
+    initialBuffer(initialSize)
+{
+    resource.emplace(initialBuffer.data(), initialBuffer.size());
+}
+
+void FrameArena::reset() {
+    highWaterMark = std::max(highWaterMark, bytesUsed);
+    bytesUsed = 0;
+    resource.reset();
+    // Grow the first buffer to fit the largest frame seen, so that later frames don't need to allocate more from upstream
+    if(highWaterMark > initialBuffer.size())
+        initialBuffer = std::vector<std::byte>(highWaterMark + highWaterMark / 2);
+    resource.emplace(initialBuffer.data(), initialBuffer.size());
+}
+
+size_t FrameArena::bytes_used() const {
+    return bytesUsed;
+}
+
+size_t FrameArena::high_water_mark() const {
+    return std::max(highWaterMark, bytesUsed);
+}
+
+void* FrameArena::do_allocate(size_t bytes, size_t alignment) {
+    bytesUsed += bytes;
+    return resource->allocate(bytes, alignment);
+}
+
+void FrameArena::do_deallocate(void* p, size_t bytes, size_t alignment) {
+}
+
+bool FrameArena::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
+    return this == &other;
+}
+
+}
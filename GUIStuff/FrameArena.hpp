@@ -0,0 +1,32 @@
+#pragma once
+#include <memory_resource>
+#include <optional>
+#include <vector>
+#include <cstddef>
+
+namespace GUIStuff {
+
+// Bump allocator for data that only needs to live for one frame. Pass it to std::pmr containers, ex.
+// std::pmr::vector<int> v(io.frameArena);
+// Deallocation does nothing, all memory is released at once by reset(), which GUIManager calls in begin()
+class FrameArena : public std::pmr::memory_resource {
+    public:
+        FrameArena(size_t initialSize = 64 * 1024);
+        FrameArena(const FrameArena&) = delete;
+        FrameArena& operator=(const FrameArena&) = delete;
+
+        void reset();
+        size_t bytes_used() const; // Bytes allocated since the last reset
+        size_t high_water_mark() const; // Largest bytes_used seen at a reset
+    private:
+        virtual void* do_allocate(size_t bytes, size_t alignment) override;
+        virtual void do_deallocate(void* p, size_t bytes, size_t alignment) override;
+        virtual bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+        std::vector<std::byte> initialBuffer;
+        std::optional<std::pmr::monotonic_buffer_resource> resource;
+        size_t bytesUsed = 0;
+        size_t highWaterMark = 0;
+};
+
+}
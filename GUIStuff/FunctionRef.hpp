@@ -0,0 +1,53 @@
+#pragma once
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <type_traits>
+
+namespace GUIStuff {
+
+template <typename Fn> class FunctionRef;
+
+// Non-owning reference to a callable, used for callbacks that are only called during the function they're passed to.
+// Unlike std::function it never allocates, and lambdas passed to it can be inlined into the call thunk.
+// Don't store it past the call, since it doesn't extend the lifetime of the callable
+template <typename R, typename... Args> class FunctionRef<R(Args...)> {
+    public:
+        FunctionRef() = default;
+        FunctionRef(std::nullptr_t) {}
+
+        template <typename F> requires (!std::is_same_v<std::remove_cvref_t<F>, FunctionRef> && std::is_invocable_r_v<R, F&, Args...>)
+        FunctionRef(F&& f):
+            obj(const_cast<void*>(static_cast<const void*>(std::addressof(f)))),
+            callback(&call<std::remove_reference_t<F>>)
+        {
+            // Keep empty std::functions and null function pointers empty. Captureless lambdas convert to bool implicitly through
+            // their function pointer, which is never null, so only pointers and types with an explicit operator bool are checked
+            using FType = std::remove_cvref_t<F>;
+            if constexpr(std::is_pointer_v<FType> || std::is_member_pointer_v<FType> || (std::is_constructible_v<bool, F&> && !std::is_convertible_v<F&, bool>)) {
+                if(!static_cast<bool>(f))
+                    callback = nullptr;
+            }
+        }
+
+        R operator()(Args... args) const {
+            return callback(obj, std::forward<Args>(args)...);
+        }
+
+        explicit operator bool() const {
+            return callback != nullptr;
+        }
+
+    private:
+        template <typename F> static R call(void* o, Args... args) {
+            if constexpr(std::is_void_v<R>)
+                std::invoke(*static_cast<F*>(o), std::forward<Args>(args)...);
+            else
+                return std::invoke(*static_cast<F*>(o), std::forward<Args>(args)...);
+        }
+
+        void* obj = nullptr;
+        R (*callback)(void*, Args...) = nullptr;
+};
+
+}
@@ -2,7 +2,6 @@
 #include "include/core/SkPaint.h"
 #include "include/core/SkRRect.h"
 #include "include/core/SkFont.h"
-#include "include/core/SkFontMetrics.h"
 #include "include/core/SkPath.h"
 #include "Elements/SVGIcon.hpp"
 #include "Elements/SelectableButton.hpp"
@@ -12,165 +11,369 @@
 #include <filesystem>
 #include <fstream>
 #include <iostream>
+#include <cassert>
 #include <cmath>
+#include <cstring>
 
 namespace GUIStuff {
 
-GUIManager::GUIManager():
-    clayArena(Clay_CreateArenaWithCapacityAndMemory(Clay_MinMemorySize(), malloc(Clay_MinMemorySize())))
-{
-    clayInstance = Clay_Initialize(clayArena, Clay_Dimensions(1.0f, 1.0f), (Clay_ErrorHandler)clay_error_handler);
-    Clay_SetMeasureTextFunction(clay_skia_measure_text, this);
+GUIManager::GUIManager() {
+    initialize_clay();
     //Clay_SetDebugModeEnabled(true);
 }
 
+GUIManager::~GUIManager() {
+    for(auto& [id, container] : elements)
+        container.pool->destroy(container.obj);
+    free(clayArena.memory);
+}
+
+void GUIManager::initialize_clay() {
+    // Clay_MinMemorySize and Clay_Initialize take the max counts from the current context, so it has to be this instance's
+    if(clayInstance)
+        Clay_SetCurrentContext(clayInstance);
+    uint32_t memorySize = Clay_MinMemorySize();
+    Clay_Arena newArena = Clay_CreateArenaWithCapacityAndMemory(memorySize, malloc(memorySize));
+    clayInstance = Clay_Initialize(newArena, Clay_Dimensions(1.0f, 1.0f), Clay_ErrorHandler{.errorHandlerFunction = clay_error_handler, .userData = this});
+    Clay_SetMeasureTextFunction(clay_skia_measure_text, this);
+    free(clayArena.memory);
+    clayArena = newArena;
+
+    clayStats.maxElementCount = Clay_GetMaxElementCount();
+    clayStats.maxMeasureTextWordCount = Clay_GetMaxMeasureTextCacheWordCount();
+    clayStats.arenaCapacity = clayArena.capacity;
+}
+
+void GUIManager::grow_clay_capacity() {
+    Clay_SetCurrentContext(clayInstance);
+    if(clayElementCapacityExceeded)
+        Clay_SetMaxElementCount(Clay_GetMaxElementCount() * 2);
+    if(clayWordCapacityExceeded)
+        Clay_SetMaxMeasureTextCacheWordCount(Clay_GetMaxMeasureTextCacheWordCount() * 2);
+    clayElementCapacityExceeded = false;
+    clayWordCapacityExceeded = false;
+    // Element state is kept in elements, not in Clay, so only Clay's own state (such as scroll positions) is reset
+    initialize_clay();
+    clayStats.reinitializeCount++;
+}
+
+const GUIManager::ClayCapacityStats& GUIManager::clay_capacity_stats() const {
+    return clayStats;
+}
+
+GUIManager::StyleHandle GUIManager::register_style(StyleBuilder builder) {
+    for(size_t i = 0; i < styles.size(); i++) {
+        if(styles[i].builder == builder)
+            return i;
+    }
+    styles.emplace_back(InternedStyle{builder, {}});
+    if(stylesTheme)
+        styles.back().declaration = builder(*stylesTheme);
+    return styles.size() - 1;
+}
+
+const Clay_ElementDeclaration& GUIManager::style(StyleHandle handle) const {
+    return styles[handle].declaration;
+}
+
+void GUIManager::invalidate_styles() {
+    stylesTheme = nullptr;
+}
+
+void GUIManager::resolve_styles() {
+    stylesTheme = io->theme;
+    // Custom element hashes don't include the theme
+    damageTracker.invalidate();
+    for(InternedStyle& s : styles)
+        s.declaration = s.builder(*stylesTheme);
+    labelTextConfig = {.textColor = convert_vec4<Clay_Color>(stylesTheme->frontColor1), .fontSize = stylesTheme->fontSize};
+}
+
 Clay_Dimensions GUIManager::clay_skia_measure_text(Clay_StringSlice str, Clay_TextElementConfig* config, void* userData) {
     GUIManager* window = static_cast<GUIManager*>(userData);
-    SkFont font = window->io->theme->get_font(config->fontSize);
-    SkFontMetrics metrics;
-    font.getMetrics(&metrics);
-    float nextText = font.measureText(str.chars, str.length, SkTextEncoding::kUTF8, nullptr);
-    return Clay_Dimensions(nextText, - metrics.fAscent + metrics.fDescent);
+    const Theme& theme = *window->io->theme;
+    float width = window->textMeasureCache.measure_width(std::string_view(str.chars, str.length), config->fontSize, theme);
+    return Clay_Dimensions(width, window->textMeasureCache.line_height(config->fontSize, theme));
+}
+
+const TextMeasureCache& GUIManager::text_measure_cache() const {
+    return textMeasureCache;
+}
+
+bool GUIManager::input_pending() const {
+    const auto& mouse = io->mouse;
+    if(mouse.leftClick || mouse.leftDoubleClick || mouse.leftHeld || mouse.scroll.x() != 0.0f || mouse.scroll.y() != 0.0f || mouse.globalPos != lastMouseGlobalPos)
+        return true;
+    // Modifiers don't change anything on their own, so holding them down doesn't keep the GUI updating
+    const auto& key = io->key;
+    if(key.left || key.right || key.up || key.down || key.home || key.del || key.backspace || key.enter || key.selectAll || key.copy || key.paste || key.cut)
+        return true;
+    return !io->textInput.empty();
+}
+
+bool GUIManager::needs_update() const {
+    assert(!updateRequested || watchedValues.empty());
+    if(updateRequested || io->frameRequested || stylesTheme != io->theme || windowPos != lastWindowPos || windowSize != lastWindowSize || input_pending())
+        return true;
+    for(const WatchedValue& w : watchedValues) {
+        if(w.hash(w.val) != w.lastHash)
+            return true;
+    }
+    return false;
+}
+
+void GUIManager::request_update() {
+    updateRequested = true;
+    watchedValues.clear();
+}
+
+bool GUIManager::needs_redraw() const {
+    return redrawPending;
 }
 
 void GUIManager::begin() {
+    updateRequested = false;
+    io->frameRequested = false;
+    watchedValues.clear();
+    lastMouseGlobalPos = io->mouse.globalPos;
+    lastWindowPos = windowPos;
+    lastWindowSize = windowSize;
+
     io->mouse.pos = io->mouse.globalPos - windowPos;
     io->strArena = &strArena;
+    io->frameArena = &frameArena;
+    if(clayElementCapacityExceeded || clayWordCapacityExceeded)
+        grow_clay_capacity();
+    if(stylesTheme != io->theme)
+        resolve_styles();
+    Clay_SetCurrentContext(clayInstance);
     Clay_SetLayoutDimensions(Clay_Dimensions(windowSize.x(), windowSize.y()));
     Clay_SetPointerState(Clay_Vector2((float)io->mouse.pos.x(), (float)io->mouse.pos.y()), io->mouse.leftHeld);
     Clay_UpdateScrollContainers(false, Clay_Vector2(io->mouse.scroll.y(), io->mouse.scroll.y()), io->deltaTime * 2.0f);
-    Clay_SetCurrentContext(clayInstance);
 
     strArena.reset();
+    frameArena.reset();
+    frameCounter++;
+
+    // Reserve from the previous frame's counts, so that opening a large panel allocates in a few large chunks
+    size_t createdLastFrame = 0;
+    for(auto& pool : pools) {
+        if(pool) {
+            pool->begin_frame();
+            createdLastFrame += pool->created_last_frame();
+        }
+    }
+    elements.reserve(elements.size() + createdLastFrame);
 
     Clay_BeginLayout();
 }
 
 void GUIManager::end() {
     renderCommands = Clay_EndLayout();
+    clayStats.renderCommandCount = renderCommands.length;
+    if(optimizeRenderCommands) {
+        renderOptimizerStats = optimize_render_commands(renderCommands, optimizedCommands);
+        drawCommands = std::span<Clay_RenderCommand>(optimizedCommands);
+    }
+    else {
+        renderOptimizerStats = RenderCommandOptimizerStats{};
+        drawCommands = std::span<Clay_RenderCommand>(renderCommands.internalArray, static_cast<size_t>(renderCommands.length));
+    }
+    SkIRect windowRect = SkIRect::MakeWH(std::ceil(windowSize.x()), std::ceil(windowSize.y()));
+    if(trackDamage)
+        damageTracker.update(drawCommands, windowRect);
+    else
+        damageTracker.damage_all(windowRect);
+    redrawPending = !damageTracker.damage().empty();
+    for(WatchedValue& w : watchedValues)
+        w.lastHash = w.hash(w.val);
     if(!idStack.empty())
         throw std::runtime_error("[GUIManager::end] ID Stack is not empty on end (push_id and pop_id calls not equal)");
+    evict_stale_elements();
+}
+
+void GUIManager::evict_stale_elements() {
+    evictionStats.evictedLastFrame = 0;
+    size_t liveBytes = pool_live_bytes();
+    // Carries on from where the last end() stopped. A rehash reorders the elements, which only moves where checking continues from
+    auto it = evictionCursor ? elements.find(*evictionCursor) : elements.end();
+    if(it == elements.end())
+        it = elements.begin();
+    size_t elementsToCheck = std::min(evictionPolicy.elementsPerFrame, elements.size());
+
+    for(size_t i = 0; i < elementsToCheck && !elements.empty(); i++) {
+        if(it == elements.end())
+            it = elements.begin();
+        ElementContainer& c = it->second;
+        // Elements touched this frame might be referenced by this frame's render commands, so they're never evicted
+        bool idleTooLong = evictionPolicy.maxIdleFrames != 0 && (frameCounter - c.lastTouchedFrame) > evictionPolicy.maxIdleFrames;
+        bool overBudget = evictionPolicy.byteBudget != 0 && liveBytes > evictionPolicy.byteBudget;
+        if(c.lastTouchedFrame != frameCounter && (idleTooLong || overBudget)) {
+            liveBytes -= c.pool->object_size();
+            c.pool->destroy(c.obj);
+            it = elements.erase(it);
+            evictionStats.evictedLastFrame++;
+        }
+        else
+            ++it;
+    }
+
+    if(it == elements.end())
+        evictionCursor.reset();
+    else
+        evictionCursor = it->first;
+
+    evictionStats.evictedTotal += evictionStats.evictedLastFrame;
+    evictionStats.liveBytes = liveBytes;
+}
+
+size_t GUIManager::pool_live_bytes() const {
+    size_t toRet = 0;
+    for(auto& pool : pools) {
+        if(pool)
+            toRet += pool->live_count() * pool->object_size();
+    }
+    return toRet;
+}
+
+const GUIManager::EvictionStats& GUIManager::eviction_stats() const {
+    return evictionStats;
+}
+
+const RenderCommandOptimizerStats& GUIManager::render_optimizer_stats() const {
+    return renderOptimizerStats;
+}
+
+const std::vector<SkIRect>& GUIManager::damage() const {
+    return damageTracker.damage();
+}
+
+bool GUIManager::full_damage() const {
+    return damageTracker.full_damage();
+}
+
+void GUIManager::draw_damaged(SkCanvas* canvas) {
+    SkPath damagePath;
+    for(const SkIRect& r : damageTracker.damage())
+        damagePath.addRect(SkRect::Make(r).makeOffset(windowPos.x(), windowPos.y()));
+    canvas->save();
+    canvas->clipPath(damagePath);
+    // The canvas still has the last frame's pixels, and the theme's colors can be translucent, so they're cleared before drawing over them
+    canvas->clear(SK_ColorTRANSPARENT);
+    draw(canvas);
+    canvas->restore();
+}
+
+const FrameArena& GUIManager::frame_arena() const {
+    return frameArena;
+}
+
+size_t GUIManager::draw_text_commands(SkCanvas* canvas, size_t start) {
+    Clay_RenderCommand* first = &drawCommands[start];
+    Clay_TextRenderData* firstConfig = &first->renderData.text;
+
+    // Consecutive text commands with the same color and size can be drawn together. Scissor changes are separate
+    // render commands, so a run of text commands is always under the same clip
+    size_t end = start + 1;
+    if(batchTextCommands) {
+        for(; end < drawCommands.size(); end++) {
+            Clay_RenderCommand* command = &drawCommands[end];
+            if(command->commandType != CLAY_RENDER_COMMAND_TYPE_TEXT)
+                break;
+            Clay_TextRenderData* config = &command->renderData.text;
+            if(config->fontSize != firstConfig->fontSize || std::memcmp(&config->textColor, &firstConfig->textColor, sizeof(Clay_Color)) != 0)
+                break;
+        }
+    }
+
+    SkPaint& paint = fillPaint;
+    paint.setColor4f(clay_color_to_sk(firstConfig->textColor));
+
+    if(end - start == 1) {
+        const TextBlobCache::Blob& blob = textBlobCache.get(std::string_view(firstConfig->stringContents.chars, firstConfig->stringContents.length), firstConfig->fontSize, *io->theme);
+        if(blob.blob)
+            canvas->drawTextBlob(blob.blob, first->boundingBox.x, first->boundingBox.y + first->boundingBox.height - blob.descent, paint);
+        return 1;
+    }
+
+    for(size_t i = start; i < end; i++) {
+        Clay_RenderCommand* command = &drawCommands[i];
+        Clay_TextRenderData* config = &command->renderData.text;
+        Clay_BoundingBox bb = command->boundingBox;
+        const TextBlobCache::Blob& blob = textBlobCache.get(std::string_view(config->stringContents.chars, config->stringContents.length), config->fontSize, *io->theme);
+        if(blob.glyphs.empty())
+            continue;
+        const SkTextBlobBuilder::RunBuffer& run = textBatchBuilder.allocRunPosH(*blob.font, blob.glyphs.size(), bb.y + bb.height - blob.descent);
+        std::copy(blob.glyphs.begin(), blob.glyphs.end(), run.glyphs);
+        for(size_t j = 0; j < blob.xPositions.size(); j++)
+            run.pos[j] = blob.xPositions[j] + bb.x;
+    }
+    sk_sp<SkTextBlob> batch = textBatchBuilder.make();
+    if(batch)
+        canvas->drawTextBlob(batch, 0.0f, 0.0f, paint);
+    return end - start;
+}
+
+SkColor4f GUIManager::clay_color_to_sk(const Clay_Color& c) {
+    return {c.r, c.g, c.b, c.a};
+}
+
+SkRRect GUIManager::make_rrect(const SkRect& rect, const Clay_CornerRadius& radius, float radiusOffset) {
+    auto r = [&](float cornerRadius) {
+        float adjusted = cornerRadius > 0.0f ? std::max(cornerRadius + radiusOffset, 0.0f) : 0.0f;
+        return SkVector{adjusted, adjusted};
+    };
+    SkVector radii[4] = {r(radius.topLeft), r(radius.topRight), r(radius.bottomRight), r(radius.bottomLeft)};
+    SkRRect rrect;
+    rrect.setRectRadii(rect, radii);
+    return rrect;
 }
 
 void GUIManager::draw(SkCanvas* canvas) {
+    redrawPending = false;
     canvas->save();
     canvas->translate(windowPos.x(), windowPos.y());
 
-    for(size_t i = 0; i < static_cast<size_t>(renderCommands.length); i++) {
-        Clay_RenderCommand* command = Clay_RenderCommandArray_Get(&renderCommands, i);
+    for(size_t i = 0; i < drawCommands.size(); i++) {
+        Clay_RenderCommand* command = &drawCommands[i];
         Clay_BoundingBox bb = command->boundingBox;
         switch(command->commandType) {
             case CLAY_RENDER_COMMAND_TYPE_RECTANGLE: {
                 Clay_RectangleRenderData* config = &command->renderData.rectangle;
-                SkVector radii[4] = {
-                    {config->cornerRadius.topLeft, config->cornerRadius.topLeft},
-                    {config->cornerRadius.topRight, config->cornerRadius.topRight},
-                    {config->cornerRadius.bottomRight, config->cornerRadius.bottomRight},
-                    {config->cornerRadius.bottomLeft, config->cornerRadius.bottomLeft}
-                };
-
-                SkRRect rrect;
-                rrect.setRectRadii(
-                    SkRect::MakeXYWH(bb.x, bb.y, bb.width, bb.height),
-                    radii
-                );
-
-                SkPaint paint;
-                paint.setStyle(SkPaint::kFill_Style);
-                paint.setColor4f(convert_vec4<SkColor4f>(config->backgroundColor));
-                canvas->drawRRect(rrect, paint);
-
+                fillPaint.setColor4f(clay_color_to_sk(config->backgroundColor));
+                SkRect rect = SkRect::MakeXYWH(bb.x, bb.y, bb.width, bb.height);
+                if(config->cornerRadius.topLeft == 0.0f && config->cornerRadius.topRight == 0.0f && config->cornerRadius.bottomRight == 0.0f && config->cornerRadius.bottomLeft == 0.0f)
+                    canvas->drawRect(rect, fillPaint);
+                else
+                    canvas->drawRRect(make_rrect(rect, config->cornerRadius, 0.0f), fillPaint);
                 break;
             }
             case CLAY_RENDER_COMMAND_TYPE_TEXT: {
-                Clay_TextRenderData* config = &command->renderData.text;
-                SkPaint paint;
-                paint.setColor4f(convert_vec4<SkColor4f>(config->textColor));
-                SkFont f = io->theme->get_font(config->fontSize);
-                SkFontMetrics metrics;
-                f.getMetrics(&metrics);
-                canvas->drawSimpleText(config->stringContents.chars, config->stringContents.length, SkTextEncoding::kUTF8, bb.x, (bb.y + bb.height - metrics.fDescent), io->theme->get_font(config->fontSize), paint);
+                i += draw_text_commands(canvas, i) - 1;
                 break;
             }
             case CLAY_RENDER_COMMAND_TYPE_BORDER: {
                 Clay_BorderRenderData* config = &command->renderData.border;
-
-                SkPaint p;
-                p.setColor4f(convert_vec4<SkColor4f>(config->color));
-                p.setStyle(SkPaint::kStroke_Style);
-
-                float halfLineWidth = 0.0f;
-                // Top Left corner
-                if (config->cornerRadius.topLeft > 0.0f) {
-                    SkPath path;
-                    float lineWidth = config->width.top;
-                    p.setStrokeWidth(lineWidth);
-                    path.moveTo(bb.x + halfLineWidth, bb.y + config->cornerRadius.topLeft + halfLineWidth);
-                    path.arcTo((bb.x + halfLineWidth), (bb.y + halfLineWidth), (bb.x + config->cornerRadius.topLeft + halfLineWidth), (bb.y + halfLineWidth), config->cornerRadius.topLeft);
-                    canvas->drawPath(path, p);
+                fillPaint.setColor4f(clay_color_to_sk(config->color));
+                SkRect rect = SkRect::MakeXYWH(bb.x, bb.y, bb.width, bb.height);
+                const Clay_BorderWidth& w = config->width;
+                // Borders are centered on the edge of the bounding box, so they're filled between rounded rects half a width outside and inside it
+                if(w.left == w.right && w.left == w.top && w.left == w.bottom) {
+                    if(w.left == 0)
+                        break;
+                    float halfWidth = w.left * 0.5f;
+                    canvas->drawDRRect(make_rrect(rect.makeOutset(halfWidth, halfWidth), config->cornerRadius, halfWidth), make_rrect(rect.makeInset(halfWidth, halfWidth), config->cornerRadius, -halfWidth), fillPaint);
                 }
-                // Top border
-                if (config->width.top > 0.0f) {
+                else {
+                    SkRect outer = SkRect::MakeLTRB(rect.left() - w.left * 0.5f, rect.top() - w.top * 0.5f, rect.right() + w.right * 0.5f, rect.bottom() + w.bottom * 0.5f);
+                    SkRect inner = SkRect::MakeLTRB(rect.left() + w.left * 0.5f, rect.top() + w.top * 0.5f, rect.right() - w.right * 0.5f, rect.bottom() - w.bottom * 0.5f);
+                    float averageHalfWidth = (w.left + w.right + w.top + w.bottom) * 0.125f;
                     SkPath path;
-                    float lineWidth = config->width.top;
-                    p.setStrokeWidth(lineWidth);
-                    path.moveTo((bb.x + config->cornerRadius.topLeft + halfLineWidth), (bb.y + halfLineWidth));
-                    path.lineTo((bb.x + bb.width - config->cornerRadius.topRight - halfLineWidth), (bb.y + halfLineWidth));
-                    canvas->drawPath(path, p);
-                }
-                // Top Right Corner
-                if (config->cornerRadius.topRight > 0.0f) {
-                    SkPath path;
-                    float lineWidth = config->width.top;
-                    p.setStrokeWidth(lineWidth);
-                    path.moveTo((bb.x + bb.width - config->cornerRadius.topRight - halfLineWidth), (bb.y + halfLineWidth));
-                    path.arcTo((bb.x + bb.width - halfLineWidth), (bb.y + halfLineWidth), (bb.x + bb.width - halfLineWidth), (bb.y + config->cornerRadius.topRight + halfLineWidth), config->cornerRadius.topRight);
-                    canvas->drawPath(path, p);
-                }
-                // Right border
-                if (config->width.right > 0.0f) {
-                    SkPath path;
-                    float lineWidth = config->width.right;
-                    p.setStrokeWidth(lineWidth);
-                    path.moveTo((bb.x + bb.width - halfLineWidth), (bb.y + config->cornerRadius.topRight + halfLineWidth));
-                    path.lineTo((bb.x + bb.width - halfLineWidth), (bb.y + bb.height - config->cornerRadius.bottomRight - halfLineWidth));
-                    canvas->drawPath(path, p);
-                }
-                // Bottom Right Corner
-                if (config->cornerRadius.bottomRight > 0.0f) {
-                    SkPath path;
-                    float lineWidth = config->width.bottom;
-                    p.setStrokeWidth(lineWidth);
-                    path.moveTo((bb.x + bb.width - halfLineWidth), (bb.y + bb.height - config->cornerRadius.bottomRight - halfLineWidth));
-                    path.arcTo((bb.x + bb.width - halfLineWidth), (bb.y + bb.height - halfLineWidth), (bb.x + bb.width - config->cornerRadius.bottomRight - halfLineWidth), (bb.y + bb.height - halfLineWidth), config->cornerRadius.bottomRight);
-                    canvas->drawPath(path, p);
-                }
-                // Bottom Border
-                if (config->width.bottom > 0.0f) {
-                    SkPath path;
-                    float lineWidth = config->width.bottom;
-                    p.setStrokeWidth(lineWidth);
-                    path.moveTo((bb.x + config->cornerRadius.bottomLeft + halfLineWidth), (bb.y + bb.height - halfLineWidth));
-                    path.lineTo((bb.x + bb.width - config->cornerRadius.bottomRight - halfLineWidth), (bb.y + bb.height - halfLineWidth));
-                    canvas->drawPath(path, p);
-                }
-                // Bottom Left Corner
-                if (config->cornerRadius.bottomLeft > 0.0f) {
-                    SkPath path;
-                    float lineWidth = config->width.bottom;
-                    p.setStrokeWidth(lineWidth);
-                    path.moveTo((bb.x + config->cornerRadius.bottomLeft + halfLineWidth), (bb.y + bb.height - halfLineWidth));
-                    path.arcTo((bb.x + halfLineWidth), (bb.y + bb.height - halfLineWidth), (bb.x + halfLineWidth), (bb.y + bb.height - config->cornerRadius.bottomLeft - halfLineWidth), config->cornerRadius.bottomLeft);
-                    canvas->drawPath(path, p);
-                }
-                // Left Border
-                if (config->width.left > 0.0f) {
-                    SkPath path;
-                    float lineWidth = config->width.left;
-                    p.setStrokeWidth(lineWidth);
-                    path.moveTo((bb.x + halfLineWidth), (bb.y + bb.height - config->cornerRadius.bottomLeft - halfLineWidth));
-                    path.lineTo((bb.x + halfLineWidth), (bb.y + config->cornerRadius.topRight + halfLineWidth));
-                    canvas->drawPath(path, p);
+                    path.addRRect(make_rrect(outer, config->cornerRadius, averageHalfWidth));
+                    if(!inner.isEmpty())
+                        path.addRRect(make_rrect(inner, config->cornerRadius, -averageHalfWidth));
+                    path.setFillType(SkPathFillType::kEvenOdd);
+                    canvas->drawPath(path, fillPaint);
                 }
                 break;
             }
@@ -197,7 +400,7 @@ void GUIManager::draw(SkCanvas* canvas) {
     canvas->restore();
 }
 
-void GUIManager::top_to_bottom_window_popup_layout(Clay_SizingAxis x, Clay_SizingAxis y, const std::function<void()>& elemUpdate) {
+void GUIManager::top_to_bottom_window_popup_layout(Clay_SizingAxis x, Clay_SizingAxis y, FunctionRef<void()> elemUpdate) {
     CLAY({.layout = { 
             .sizing = {.width = x, .height = y },
             .padding = CLAY_PADDING_ALL(io->theme->padding1),
@@ -215,7 +418,7 @@ void GUIManager::top_to_bottom_window_popup_layout(Clay_SizingAxis x, Clay_Sizin
     }
 }
 
-void GUIManager::left_to_right_layout(Clay_SizingAxis x, Clay_SizingAxis y, const std::function<void()>& elemUpdate) {
+void GUIManager::left_to_right_layout(Clay_SizingAxis x, Clay_SizingAxis y, FunctionRef<void()> elemUpdate) {
     CLAY({.layout = { 
           .sizing = {.width = x, .height = y },
           .childGap = io->theme->childGap1,
@@ -227,26 +430,34 @@ void GUIManager::left_to_right_layout(Clay_SizingAxis x, Clay_SizingAxis y, cons
     }
 }
 
-void GUIManager::left_to_right_line_layout(const std::function<void()>& elemUpdate) {
+void GUIManager::left_to_right_line_layout(FunctionRef<void()> elemUpdate) {
     left_to_right_layout(CLAY_SIZING_GROW(0), CLAY_SIZING_FIT(0), elemUpdate);
 }
 
-void GUIManager::text_label(const std::string& val) {
-    CLAY_TEXT(strArena.std_str_to_clay_str(val), CLAY_TEXT_CONFIG({.textColor = convert_vec4<Clay_Color>(io->theme->frontColor1), .fontSize = io->theme->fontSize }));
+void GUIManager::text_label(std::string_view val) {
+    text_label_clay_str(strArena.std_str_to_clay_str(val));
+}
+
+void GUIManager::text_label_centered(std::string_view val) {
+    text_label_centered_clay_str(strArena.std_str_to_clay_str(val));
 }
 
-void GUIManager::text_label_centered(const std::string& val) {
+void GUIManager::text_label_clay_str(const Clay_String& str) {
+    CLAY_TEXT(str, &labelTextConfig);
+}
+
+void GUIManager::text_label_centered_clay_str(const Clay_String& str) {
     CLAY({
         .layout = {
             .sizing = {.width = CLAY_SIZING_GROW(0), .height = CLAY_SIZING_FIT(0) },
             .childAlignment = {.x = CLAY_ALIGN_X_CENTER, .y = CLAY_ALIGN_Y_CENTER},
         }
     }) {
-        CLAY_TEXT(strArena.std_str_to_clay_str(val), CLAY_TEXT_CONFIG({.textColor = convert_vec4<Clay_Color>(io->theme->frontColor1), .fontSize = io->theme->fontSize }));
+        text_label_clay_str(str);
     }
 }
 
-bool GUIManager::radio_button(const std::string& id, bool val, const std::function<void()>& elemUpdate) {
+bool GUIManager::radio_button(const GUIManagerID& id, bool val, FunctionRef<void()> elemUpdate) {
     push_id(id);
     RadioButton* e = insert_element<RadioButton>(); 
     e->update(*io, val, elemUpdate);
@@ -254,7 +465,8 @@ bool GUIManager::radio_button(const std::string& id, bool val, const std::functi
     return e->selection.clicked;
 }
 
-void GUIManager::checkbox(const std::string& id, bool* val, const std::function<void()>& elemUpdate) {
+void GUIManager::checkbox(const GUIManagerID& id, bool* val, FunctionRef<void()> elemUpdate) {
+    watch_value(val);
     push_id(id);
     CheckBox* e = insert_element<CheckBox>(); 
     e->update(*io, *val, elemUpdate);
@@ -263,28 +475,28 @@ void GUIManager::checkbox(const std::string& id, bool* val, const std::function<
     pop_id();
 }
 
-void GUIManager::input_text_field(const std::string& id, const std::string& name, std::string* val, const std::function<void()>& elemUpdate) {
+void GUIManager::input_text_field(const GUIManagerID& id, std::string_view name, std::string* val, FunctionRef<void()> elemUpdate) {
     left_to_right_line_layout([&]() {
         text_label(name);
         input_text(id, val, elemUpdate);
     });
 }
 
-void GUIManager::input_path_field(const std::string& id, const std::string& name, std::filesystem::path* val, std::filesystem::file_type fileTypeRestriction, const std::function<void()>& elemUpdate) {
+void GUIManager::input_path_field(const GUIManagerID& id, std::string_view name, std::filesystem::path* val, std::filesystem::file_type fileTypeRestriction, FunctionRef<void()> elemUpdate) {
     left_to_right_line_layout([&]() {
         text_label(name);
         input_path(id, val, fileTypeRestriction, elemUpdate);
     });
 }
 
-void GUIManager::checkbox_field(const std::string& id, const std::string& name, bool* val, const std::function<void()>& elemUpdate) {
+void GUIManager::checkbox_field(const GUIManagerID& id, std::string_view name, bool* val, FunctionRef<void()> elemUpdate) {
     left_to_right_line_layout([&]() {
         checkbox(id, val, elemUpdate);
         text_label(name);
     });
 }
 
-bool GUIManager::radio_button_field(const std::string& id, const std::string& name, bool val, const std::function<void()>& elemUpdate) {
+bool GUIManager::radio_button_field(const GUIManagerID& id, std::string_view name, bool val, FunctionRef<void()> elemUpdate) {
     bool toRet;
     left_to_right_line_layout([&]() {
         toRet = radio_button(id, val, elemUpdate);
@@ -293,38 +505,15 @@ bool GUIManager::radio_button_field(const std::string& id, const std::string& na
     return toRet;
 }
 
-void GUIManager::input_color_component_255(const std::string& id, float* val, const std::function<void()>& elemUpdate) {
-    push_id(id);
-    insert_element<TextBox<float>>()->update(*io, val,
-        [&](const std::string& str) {
-            int roundTo255;
-            std::stringstream ss;
-            ss << str;
-            ss >> roundTo255;
-            return std::clamp<float>(static_cast<float>(roundTo255) / 255.0f, 0.0f, 1.0f);
-        },
-        [&](const float& colorFloat) {
-            int convertTo255 = colorFloat * 255;
-            std::stringstream ss;
-            ss << convertTo255;
-            return ss.str();
-        }, true, elemUpdate);
-    pop_id();
+void GUIManager::input_color_component_255(const GUIManagerID& id, float* val, FunctionRef<void()> elemUpdate) {
+    input_codec(id, val, Color255Codec{}, true, elemUpdate);
 }
 
-void GUIManager::input_text(const std::string& id, std::string* val, const std::function<void()>& elemUpdate) {
-    push_id(id);
-    insert_element<TextBox<std::string>>()->update(*io, val,
-        [&](const std::string& str) {
-            return str;
-        },
-        [&](const std::string& str) {
-            return str;
-        }, true, elemUpdate);
-    pop_id();
+void GUIManager::input_text(const GUIManagerID& id, std::string* val, FunctionRef<void()> elemUpdate) {
+    input_codec(id, val, StringCodec{}, true, elemUpdate);
 }
 
-bool GUIManager::selectable_button(const std::string& id, const std::function<void(SelectionHelper&, bool)>& elemUpdate, bool hasBorder, bool hasBorderPadding, bool isSelected) {
+bool GUIManager::selectable_button(const GUIManagerID& id, FunctionRef<void(SelectionHelper&, bool)> elemUpdate, bool hasBorder, bool hasBorderPadding, bool isSelected) {
     push_id(id);
     SelectableButton* e = insert_element<SelectableButton>();
     e->update(*io, hasBorder, hasBorderPadding, elemUpdate, isSelected);
@@ -333,18 +522,18 @@ bool GUIManager::selectable_button(const std::string& id, const std::function<vo
     return toRet;
 }
 
-void GUIManager::svg_icon(const std::string& id, const std::string& svgPath, bool isHighlighted, const std::function<void()>& elemUpdate) {
+void GUIManager::svg_icon(const GUIManagerID& id, std::string_view svgPath, bool isHighlighted, FunctionRef<void()> elemUpdate) {
     push_id(id);
     insert_element<SVGIcon>()->update(*io, svgPath, isHighlighted, elemUpdate);
     pop_id();
 }
 
-bool GUIManager::svg_icon_button(const std::string& id, const std::string& svgPath, bool isSelected, float size, const std::function<void()>& elemUpdate) {
+bool GUIManager::svg_icon_button(const GUIManagerID& id, std::string_view svgPath, bool isSelected, float size, FunctionRef<void()> elemUpdate) {
     bool toRet = false;
     push_id(id);
     CLAY ({.layout = {.sizing = {.width = CLAY_SIZING_FIXED(size), .height = CLAY_SIZING_FIXED(size) } } }) {
-        toRet = selectable_button("0", [&](SelectionHelper& s, bool is) {
-            svg_icon("1", svgPath, is || s.held || s.hovered);
+        toRet = selectable_button("0"_id, [&](SelectionHelper& s, bool is) {
+            svg_icon("1"_id, svgPath, is || s.held || s.hovered);
             if(elemUpdate)
                 elemUpdate();
         }, true, true, isSelected);
@@ -353,7 +542,7 @@ bool GUIManager::svg_icon_button(const std::string& id, const std::string& svgPa
     return toRet;
 }
 
-bool GUIManager::text_button_sized(const std::string& id, const std::string& text, Clay_SizingAxis x, Clay_SizingAxis y, bool isSelected, const std::function<void()>& elemUpdate) {
+bool GUIManager::text_button_sized(const GUIManagerID& id, std::string_view text, Clay_SizingAxis x, Clay_SizingAxis y, bool isSelected, FunctionRef<void()> elemUpdate) {
     bool toRet = false;
     CLAY ({.layout = {.sizing = {.width = x, .height = y } } }) {
         toRet = selectable_button(id, [&](SelectionHelper& s, bool iS) {
@@ -365,7 +554,7 @@ bool GUIManager::text_button_sized(const std::string& id, const std::string& tex
     return toRet;
 }
 
-bool GUIManager::text_button(const std::string& id, const std::string& text, bool isSelected, const std::function<void()>& elemUpdate) {
+bool GUIManager::text_button(const GUIManagerID& id, std::string_view text, bool isSelected, FunctionRef<void()> elemUpdate) {
     bool toRet = false;
     CLAY ({.layout = {.sizing = {.width = CLAY_SIZING_FIT(0), .height = CLAY_SIZING_FIT(0) } } }) {
         toRet = selectable_button(id, [&](SelectionHelper& s, bool iS) {
@@ -377,7 +566,7 @@ bool GUIManager::text_button(const std::string& id, const std::string& text, boo
     return toRet;
 }
 
-bool GUIManager::text_button_wide(const std::string& id, const std::string& text, bool isSelected, const std::function<void()>& elemUpdate) {
+bool GUIManager::text_button_wide(const GUIManagerID& id, std::string_view text, bool isSelected, FunctionRef<void()> elemUpdate) {
     bool toRet = false;
     CLAY ({.layout = {.sizing = {.width = CLAY_SIZING_GROW(0), .height = CLAY_SIZING_FIT(0) } } }) {
         toRet = selectable_button(id, [&](SelectionHelper& s, bool iS) {
@@ -389,48 +578,22 @@ bool GUIManager::text_button_wide(const std::string& id, const std::string& text
     return toRet;
 }
 
-void GUIManager::input_scalar(const std::string& id, uint8_t* val, uint8_t min, uint8_t max, const std::function<void()>& elemUpdate) {
-    push_id(id);
-    insert_element<TextBox<uint8_t>>()->update(*io, val, 
-        [&](const std::string& a) {
-            if(a.empty())
-                return min;
-            uint32_t toRet;
-            std::stringstream ss;
-            ss << a;
-            ss >> toRet;
-            if(ss.fail())
-                return min;
-            return std::clamp<uint8_t>(toRet, min, max);
-        },
-        [&](const uint8_t& a) {
-            return std::to_string(static_cast<uint32_t>(a));
-        }, true, elemUpdate);
-    pop_id();
+void GUIManager::input_scalar(const GUIManagerID& id, uint8_t* val, uint8_t min, uint8_t max, FunctionRef<void()> elemUpdate) {
+    input_codec(id, val, ScalarCodec<uint8_t>{min, max}, true, elemUpdate);
 }
 
-void GUIManager::input_path(const std::string& id, std::filesystem::path* val, std::filesystem::file_type fileTypeRestriction, const std::function<void()>& elemUpdate) {
-    push_id(id);
-    insert_element<TextBox<std::filesystem::path>>()->update(*io, val, 
-        [&](const std::string& a) {
-            std::filesystem::path toRet = std::filesystem::path(a);
-            if(fileTypeRestriction != std::filesystem::file_type::none && std::filesystem::status(toRet).type() != fileTypeRestriction)
-                return std::optional<std::filesystem::path>(std::nullopt);
-            return std::optional<std::filesystem::path>(toRet);
-        },
-        [&](const std::filesystem::path& a) {
-            return a.string();
-        }, true, elemUpdate);
-    pop_id();
+void GUIManager::input_path(const GUIManagerID& id, std::filesystem::path* val, std::filesystem::file_type fileTypeRestriction, FunctionRef<void()> elemUpdate) {
+    input_codec(id, val, PathCodec{fileTypeRestriction}, true, elemUpdate);
 }
 
-void GUIManager::tab_list(const std::string& id, const std::vector<std::pair<std::string, std::string>>& tabNames, size_t& selectedTab, std::optional<size_t>& closedTab, const std::function<void()>& elemUpdate) {
+void GUIManager::tab_list(const GUIManagerID& id, std::span<const MovableTabList::TabName> tabNames, size_t& selectedTab, std::optional<size_t>& closedTab, FunctionRef<void()> elemUpdate) {
     push_id(id);
     insert_element<MovableTabList>()->update(*io, tabNames, selectedTab, closedTab, elemUpdate);
     pop_id();
 }
 
-void GUIManager::dropdown_select(const std::string& id, size_t* val, const std::vector<std::string>& selections, float width) {
+void GUIManager::dropdown_select(const GUIManagerID& id, size_t* val, const std::vector<std::string>& selections, float width) {
+    watch_value(val);
     push_id(id);
     bool& dropDownOpen = insert_any_with_id(0, false);
     left_to_right_layout(CLAY_SIZING_FIXED(width), CLAY_SIZING_FIT(0), [&]() {
@@ -451,7 +614,7 @@ void GUIManager::dropdown_select(const std::string& id, size_t* val, const std::
                         .sizing = {.width = CLAY_SIZING_FIT(20), .height = CLAY_SIZING_FIT(20)}
                     }
                 }) {
-                    svg_icon("dropico", "icons/droparrow.svg", dropDownOpen);
+                    svg_icon("dropico"_id, "icons/droparrow.svg", dropDownOpen);
                 }
             }
         }, true, false, dropDownOpen);
@@ -509,7 +672,7 @@ void GUIManager::dropdown_select(const std::string& id, size_t* val, const std::
     pop_id();
 }
 
-void GUIManager::scroll_bar_area(const std::string& uniqueId, const std::function<void(float, float, float)>& elemUpdate) {
+void GUIManager::scroll_bar_area(const GUIManagerID& uniqueId, FunctionRef<void(float, float, float)> elemUpdate) {
     CLAY({
         .layout = {
             .sizing = {.width = CLAY_SIZING_GROW(0), .height = CLAY_SIZING_GROW(0)},
@@ -527,7 +690,7 @@ void GUIManager::scroll_bar_area(const std::string& uniqueId, const std::functio
         ScrollAreaData& sD = insert_any(ScrollAreaData{});
         pop_id();
 
-        Clay_ElementId clayID = Clay_GetElementId(strArena.std_str_to_clay_str(uniqueId));
+        Clay_ElementId clayID = Clay_GetElementId(id_to_clay_str(uniqueId));
 
         CLAY({
             .id = clayID,
@@ -603,7 +766,7 @@ void GUIManager::scroll_bar_area(const std::string& uniqueId, const std::functio
 }
 
 
-void GUIManager::scroll_bar_many_entries_area(const std::string& uniqueId, float entryHeight, size_t entryCount, const std::function<void(size_t, bool)>& entryUpdate, const std::function<void(float, float, float)>& elemUpdate) {
+void GUIManager::scroll_bar_many_entries_area(const GUIManagerID& uniqueId, float entryHeight, size_t entryCount, FunctionRef<void(size_t, bool)> entryUpdate, FunctionRef<void(float, float, float)> elemUpdate) {
     push_id(uniqueId);
     scroll_bar_area(uniqueId, [&](float scrollContentHeight, float containerHeight, float scrollAmount) {
         if(elemUpdate)
@@ -648,19 +811,43 @@ void GUIManager::obstructing_window() {
 }
 
 void GUIManager::clay_error_handler(Clay_ErrorData errorData) {
-    std::cout << "[Clay Error] " << errorData.errorText.chars << std::endl;
+    GUIManager* window = static_cast<GUIManager*>(errorData.userData);
+    switch(errorData.errorType) {
+        case CLAY_ERROR_TYPE_ELEMENTS_CAPACITY_EXCEEDED:
+            // Clay reports this for every element past the limit, so only log once until capacity grows
+            if(!window->clayElementCapacityExceeded)
+                std::cout << "[Clay Error] Element capacity exceeded, growing before next frame" << std::endl;
+            window->clayElementCapacityExceeded = true;
+            break;
+        case CLAY_ERROR_TYPE_TEXT_MEASUREMENT_CAPACITY_EXCEEDED:
+            if(!window->clayWordCapacityExceeded)
+                std::cout << "[Clay Error] Measure text word capacity exceeded, growing before next frame" << std::endl;
+            window->clayWordCapacityExceeded = true;
+            break;
+        default:
+            std::cout << "[Clay Error] " << std::string_view(errorData.errorText.chars, errorData.errorText.length) << std::endl;
+            break;
+    }
 }
 
 void GUIManager::push_id(int64_t id) {
-    idStack.emplace_back(id);
+    idStack.push(id);
+}
+
+void GUIManager::push_id(const GUIManagerID& id) {
+    idStack.push(id);
 }
 
-void GUIManager::push_id(const std::string& id) {
-    idStack.emplace_back(id);
+Clay_String GUIManager::id_to_clay_str(const GUIManagerID& id) {
+    if(id.idIsStatic)
+        return Clay_String{.length = static_cast<int32_t>(id.idStaticStr.size()), .chars = id.idStaticStr.data()};
+    else if(id.idIsStr)
+        return strArena.std_str_to_clay_str(id.idStr);
+    return format_to_clay_str("{}", id.idNum);
 }
 
 void GUIManager::pop_id() {
-    idStack.pop_back();
+    idStack.pop();
 }
 
 }
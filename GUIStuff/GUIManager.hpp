@@ -1,5 +1,6 @@
 #pragma once
 #include "include/core/SkCanvas.h"
+#include "include/core/SkRRect.h"
 #include <Eigen/Dense>
 #include "Elements/Element.hpp"
 #include "Elements/NumberSlider.hpp"
@@ -7,9 +8,17 @@
 #include "Elements/RadioButton.hpp"
 #include "Elements/ColorPicker.hpp"
 #include "Elements/TextBox.hpp"
-#include <any>
+#include "Elements/MovableTabList.hpp"
 #include "GUIManagerID.hpp"
+#include "SlabPool.hpp"
+#include "TextMeasureCache.hpp"
+#include "TextBlobCache.hpp"
+#include "RenderCommandOptimizer.hpp"
+#include "DamageTracker.hpp"
 #include <filesystem>
+#include <format>
+#include <iterator>
+#include <span>
 
 #pragma GCC diagnostic push 
 #pragma GCC diagnostic ignored "-Wunused-variable"
@@ -20,18 +29,71 @@ using namespace Eigen;
 
 namespace GUIStuff {
 
+// Label text in static storage, that Clay can point at without copying it into the string arena.
+// Create using the _lbl literal, ex. gui.text_label("Red"_lbl). Other strings, including char arrays, are copied
+struct StaticLabel {
+    std::string_view str;
+};
+
+inline namespace LabelLiterals {
+    consteval StaticLabel operator""_lbl(const char* str, size_t len) {
+        return StaticLabel{std::string_view(str, len)};
+    }
+}
+
 class GUIManager {
     public:
         struct ElementContainer {
-            std::unique_ptr<Element> elem;
-            std::any extra;
+            void* obj = nullptr; // Either an Element or a value from insert_any, stored in pool
+            SlabPoolBase* pool = nullptr;
+            uint64_t lastTouchedFrame = 0;
+        };
+
+        // Elements that haven't been declared in a while are destroyed at end(), a few elements per frame
+        struct EvictionPolicy {
+            uint64_t maxIdleFrames = 1800; // Evict elements not touched for this many frames. 0 disables this rule
+            size_t byteBudget = 0; // When pool memory is above this, evict anything not touched this frame. 0 disables this rule
+            size_t elementsPerFrame = 64; // How many elements are checked each end()
+        };
+
+        struct EvictionStats {
+            size_t evictedLastFrame = 0;
+            size_t evictedTotal = 0;
+            size_t liveBytes = 0; // Bytes used by live objects in the slab pools (doesn't include memory the objects own)
+        };
+
+        // Clay's capacity. When a frame runs out of elements or measured words, the limits are doubled and Clay
+        // is reinitialized with a larger arena before the next frame
+        struct ClayCapacityStats {
+            int32_t maxElementCount = 0;
+            int32_t maxMeasureTextWordCount = 0;
+            size_t arenaCapacity = 0;
+            size_t renderCommandCount = 0; // From the last end()
+            size_t reinitializeCount = 0;
         };
 
+        // Element declarations that only depend on the theme. They're built once per theme and referenced by handle,
+        // ex. CLAY(gui.style(panelStyle)) { ... }
+        typedef Clay_ElementDeclaration (*StyleBuilder)(const Theme& theme);
+        typedef size_t StyleHandle;
+
         GUIManager();
+        GUIManager(const GUIManager&) = delete;
+        GUIManager& operator=(const GUIManager&) = delete;
+        ~GUIManager();
         void begin();
         void end();
         void draw(SkCanvas* canvas);
 
+        // Whether the next begin/end would produce a different frame. Call after filling io, and skip the frame when it returns false.
+        // It's true when there's new input, the window or theme changed, an element asked for another frame (such as while animating),
+        // a value bound through a pointer changed since the last end(), or request_update was called
+        bool needs_update() const;
+        // Call when something the GUI shows changed outside of the values bound to it. Values bound last frame are only read by
+        // needs_update until this is called, so it must also be called before destroying, or moving, any object that was bound
+        void request_update();
+        bool needs_redraw() const; // The last end() damaged part of the window, and draw hasn't been called since
+
         Vector2f windowPos = Vector2f{0.0f, 0.0f};
         Vector2f windowSize = Vector2f{0.0f, 0.0f};
         std::shared_ptr<UpdateInputData> io;
@@ -39,62 +101,111 @@ class GUIManager {
         GUIManagerIDStack idStack;
         std::unordered_map<GUIManagerIDStack, ElementContainer> elements;
 
+        EvictionPolicy evictionPolicy;
+        const EvictionStats& eviction_stats() const;
+
+        const FrameArena& frame_arena() const;
+
+        const ClayCapacityStats& clay_capacity_stats() const;
+
+        const TextMeasureCache& text_measure_cache() const;
+
+        bool batchTextCommands = true; // Draw consecutive text commands with the same color and size as one multi-run text blob
+        bool optimizeRenderCommands = true; // Drop render commands that wouldn't be visible and merge adjacent rectangles before drawing
+        const RenderCommandOptimizerStats& render_optimizer_stats() const; // From the last end()
+
+        // Parts of the window that changed since the last end(), in window coordinates (add windowPos for the canvas passed to draw).
+        // When trackDamage is off, or after the theme or window size changes, the damage is the whole window
+        bool trackDamage = true;
+        const std::vector<SkIRect>& damage() const;
+        bool full_damage() const;
+        // For canvases that keep the last drawn frame. Clears the damaged parts to transparent and draws only inside them. The clip is restored afterwards
+        void draw_damaged(SkCanvas* canvas);
+
+        StyleHandle register_style(StyleBuilder builder); // Registering the same builder twice returns the same handle
+        const Clay_ElementDeclaration& style(StyleHandle handle) const;
+        void invalidate_styles(); // Call when the theme is edited in place. Replacing io->theme is detected automatically
+
         Vector2f screen_pos_to_window_pos(const Vector2f& screenPos);
         Vector2f get_mouse_pos();
 
-        void input_text_field(const std::string& id, const std::string& name, std::string* val, const std::function<void()>& elemUpdate = nullptr);
-        void text_label(const std::string& val);
-        void text_label_centered(const std::string& val);
-        bool text_button(const std::string& id, const std::string& text, bool isSelected = false, const std::function<void()>& elemUpdate = nullptr);
-        bool text_button_wide(const std::string& id, const std::string& text, bool isSelected = false, const std::function<void()>& elemUpdate = nullptr);
-        bool text_button_sized(const std::string& id, const std::string& text, Clay_SizingAxis x, Clay_SizingAxis y, bool isSelected = false, const std::function<void()>& elemUpdate = nullptr);
+        void input_text_field(const GUIManagerID& id, std::string_view name, std::string* val, FunctionRef<void()> elemUpdate = nullptr);
+        void text_label(std::string_view val);
+        void text_label_centered(std::string_view val);
 
-        void svg_icon(const std::string& id, const std::string& svgPath, bool isHighlighted = false, const std::function<void()>& elemUpdate = nullptr);
-        bool svg_icon_button(const std::string& id, const std::string& svgPath, bool isSelected = false, float size = 40.0f, const std::function<void()>& elemUpdate = nullptr);
+        void text_label(StaticLabel val) {
+            text_label_clay_str(static_label_to_clay_str(val));
+        }
+        void text_label_centered(StaticLabel val) {
+            text_label_centered_clay_str(static_label_to_clay_str(val));
+        }
 
-        void top_to_bottom_window_popup_layout(Clay_SizingAxis x, Clay_SizingAxis y, const std::function<void()>& elemUpdate);
-        void left_to_right_layout(Clay_SizingAxis x, Clay_SizingAxis y, const std::function<void()>& elemUpdate);
-        void left_to_right_line_layout(const std::function<void()>& elemUpdate);
+        // Formats straight into the string arena, ex. gui.text_label_fmt("{} items", count)
+        template <typename... Args> void text_label_fmt(std::format_string<Args...> fmt, Args&&... args) {
+            text_label_clay_str(format_to_clay_str(fmt, std::forward<Args>(args)...));
+        }
+        template <typename... Args> void text_label_centered_fmt(std::format_string<Args...> fmt, Args&&... args) {
+            text_label_centered_clay_str(format_to_clay_str(fmt, std::forward<Args>(args)...));
+        }
+        bool text_button(const GUIManagerID& id, std::string_view text, bool isSelected = false, FunctionRef<void()> elemUpdate = nullptr);
+        bool text_button_wide(const GUIManagerID& id, std::string_view text, bool isSelected = false, FunctionRef<void()> elemUpdate = nullptr);
+        bool text_button_sized(const GUIManagerID& id, std::string_view text, Clay_SizingAxis x, Clay_SizingAxis y, bool isSelected = false, FunctionRef<void()> elemUpdate = nullptr);
+
+        void svg_icon(const GUIManagerID& id, std::string_view svgPath, bool isHighlighted = false, FunctionRef<void()> elemUpdate = nullptr);
+        bool svg_icon_button(const GUIManagerID& id, std::string_view svgPath, bool isSelected = false, float size = 40.0f, FunctionRef<void()> elemUpdate = nullptr);
 
-        bool selectable_button(const std::string& id, const std::function<void(SelectionHelper&, bool)>& elemUpdate, bool hasBorder, bool hasBorderPadding, bool isSelected);
+        void top_to_bottom_window_popup_layout(Clay_SizingAxis x, Clay_SizingAxis y, FunctionRef<void()> elemUpdate);
+        void left_to_right_layout(Clay_SizingAxis x, Clay_SizingAxis y, FunctionRef<void()> elemUpdate);
+        void left_to_right_line_layout(FunctionRef<void()> elemUpdate);
+
+        bool selectable_button(const GUIManagerID& id, FunctionRef<void(SelectionHelper&, bool)> elemUpdate, bool hasBorder, bool hasBorderPadding, bool isSelected);
 
         void push_id(int64_t id);
-        void push_id(const std::string& id);
+        void push_id(const GUIManagerID& id);
         void pop_id();
 
-        void scroll_bar_area(const std::string& uniqueId, const std::function<void(float scrollContentHeight, float containerHeight, float scrollAmount)>& elemUpdate);
-        void scroll_bar_many_entries_area(const std::string& uniqueId, float entryHeight, size_t entryCount, const std::function<void(size_t elementIndex, bool listHovered)>& entryUpdate, const std::function<void(float scrollContentHeight, float containerHeight, float scrollAmount)>& elemUpdate = nullptr);
+        void scroll_bar_area(const GUIManagerID& uniqueId, FunctionRef<void(float scrollContentHeight, float containerHeight, float scrollAmount)> elemUpdate);
+        void scroll_bar_many_entries_area(const GUIManagerID& uniqueId, float entryHeight, size_t entryCount, FunctionRef<void(size_t elementIndex, bool listHovered)> entryUpdate, FunctionRef<void(float scrollContentHeight, float containerHeight, float scrollAmount)> elemUpdate = nullptr);
 
-        void input_color_component_255(const std::string& id, float* val, const std::function<void()>& elemUpdate = nullptr);
-        void input_text(const std::string& id, std::string* val, const std::function<void()>& elemUpdate = nullptr);
+        void input_color_component_255(const GUIManagerID& id, float* val, FunctionRef<void()> elemUpdate = nullptr);
+        void input_text(const GUIManagerID& id, std::string* val, FunctionRef<void()> elemUpdate = nullptr);
 
-        bool radio_button(const std::string& id, bool val, const std::function<void()>& elemUpdate = nullptr);
-        bool radio_button_field(const std::string& id, const std::string& name, bool val, const std::function<void()>& elemUpdate = nullptr);
+        bool radio_button(const GUIManagerID& id, bool val, FunctionRef<void()> elemUpdate = nullptr);
+        bool radio_button_field(const GUIManagerID& id, std::string_view name, bool val, FunctionRef<void()> elemUpdate = nullptr);
 
-        void checkbox_field(const std::string& id, const std::string& name, bool* val, const std::function<void()>& elemUpdate = nullptr);
-        void checkbox(const std::string& id, bool* val, const std::function<void()>& elemUpdate = nullptr);
+        void checkbox_field(const GUIManagerID& id, std::string_view name, bool* val, FunctionRef<void()> elemUpdate = nullptr);
+        void checkbox(const GUIManagerID& id, bool* val, FunctionRef<void()> elemUpdate = nullptr);
 
-        void tab_list(const std::string& id, const std::vector<std::pair<std::string, std::string>>& tabNames, size_t& selectedTab, std::optional<size_t>& closedTab, const std::function<void()>& elemUpdate = nullptr);
+        void tab_list(const GUIManagerID& id, std::span<const MovableTabList::TabName> tabNames, size_t& selectedTab, std::optional<size_t>& closedTab, FunctionRef<void()> elemUpdate = nullptr);
 
-        void input_path(const std::string& id, std::filesystem::path* val, std::filesystem::file_type fileTypeRestriction, const std::function<void()>& elemUpdate = nullptr);
-        void input_path_field(const std::string& id, const std::string& name, std::filesystem::path* val, std::filesystem::file_type fileTypeRestriction, const std::function<void()>& elemUpdate = nullptr);
+        void input_path(const GUIManagerID& id, std::filesystem::path* val, std::filesystem::file_type fileTypeRestriction, FunctionRef<void()> elemUpdate = nullptr);
+        void input_path_field(const GUIManagerID& id, std::string_view name, std::filesystem::path* val, std::filesystem::file_type fileTypeRestriction, FunctionRef<void()> elemUpdate = nullptr);
 
-        void dropdown_select(const std::string& id, size_t* val, const std::vector<std::string>& selections, float width = 200.0f);
+        void dropdown_select(const GUIManagerID& id, size_t* val, const std::vector<std::string>& selections, float width = 200.0f);
 
         void obstructing_window();
 
         template <typename NewElement> NewElement* insert_element() {
-            auto [it, inserted] = elements.emplace(idStack, ElementContainer());
-            if(inserted)
-                it->second = {std::make_unique<NewElement>()};
-            return static_cast<NewElement*>(it->second.elem.get());
+            SlabPool<NewElement>& pool = get_pool<NewElement>();
+            // Look up first so that the ID stack is only copied into a key when the element is new
+            auto it = elements.find(idStack);
+            if(it == elements.end())
+                it = elements.emplace(idStack, ElementContainer{pool.create(), &pool}).first;
+            else if(it->second.pool != &pool)
+                throw std::runtime_error("[GUIManager::insert_element] Element with this ID already exists with a different type");
+            it->second.lastTouchedFrame = frameCounter;
+            return static_cast<NewElement*>(it->second.obj);
         }
 
         template <typename T> T& insert_any(const T& def) {
-            auto [it, inserted] = elements.emplace(idStack, ElementContainer());
-            if(inserted)
-                it->second.extra = def;
-            return std::any_cast<T&>(it->second.extra);
+            SlabPool<T>& pool = get_pool<T>();
+            auto it = elements.find(idStack);
+            if(it == elements.end())
+                it = elements.emplace(idStack, ElementContainer{pool.create(def), &pool}).first;
+            else if(it->second.pool != &pool)
+                throw std::runtime_error("[GUIManager::insert_any] Element with this ID already exists with a different type");
+            it->second.lastTouchedFrame = frameCounter;
+            return *static_cast<T*>(it->second.obj);
         }
 
         template <typename T> T& insert_any_with_id(int64_t id, const T& def) {
@@ -104,109 +215,69 @@ class GUIManager {
             return toRet;
         }
         
-        template <typename T> void input_generic(const std::string& id, T* val, const std::function<std::optional<T>(const std::string&)>& fromStr, const std::function<std::string(const T&)>& toStr, bool singleLine, const std::function<void()>& elemUpdate = nullptr) {
+        template <typename T> void input_generic(const GUIManagerID& id, T* val, FunctionRef<std::optional<T>(const std::string&)> fromStr, FunctionRef<std::string(const T&)> toStr, bool singleLine, FunctionRef<void()> elemUpdate = nullptr) {
+            input_codec(id, val, FunctionCodec<T>{fromStr, toStr}, singleLine, elemUpdate);
+        }
+
+        template <typename T, typename Codec> void input_codec(const GUIManagerID& id, T* val, const Codec& codec, bool singleLine, FunctionRef<void()> elemUpdate = nullptr) {
+            watch_value(val);
             push_id(id);
-            insert_element<TextBox<T>>()->update(*io, val, fromStr, toStr, singleLine, elemUpdate);
+            insert_element<TextBox<T, Codec>>()->update(*io, val, codec, singleLine, elemUpdate);
             pop_id();
         }
 
-        template <typename T> void input_scalar(const std::string& id, T* val, T min, T max, const std::function<void()>& elemUpdate = nullptr) {
-            input_generic<T>(id, val, 
-                [&](const std::string& a) {
-                    if(a.empty())
-                        return min;
-                    T toRet;
-                    std::stringstream ss;
-                    ss << a;
-                    ss >> toRet;
-                    if(ss.fail())
-                        return min;
-                    return std::clamp(toRet, min, max);
-                },
-                [&](const T& a) {
-                    return std::to_string(a);
-                }, true, elemUpdate);
+        template <typename T> void input_scalar(const GUIManagerID& id, T* val, T min, T max, FunctionRef<void()> elemUpdate = nullptr) {
+            input_codec(id, val, ScalarCodec<T>{min, max}, true, elemUpdate);
         }
 
-        void input_scalar(const std::string& id, uint8_t* val, uint8_t min, uint8_t max, const std::function<void()>& elemUpdate);
+        void input_scalar(const GUIManagerID& id, uint8_t* val, uint8_t min, uint8_t max, FunctionRef<void()> elemUpdate);
 
-        template <typename TContainer, typename T> void input_scalar_fields(const std::string& id, const std::string& name, TContainer* val, size_t elemCount, T min, T max, const std::function<void()>& elemUpdate = nullptr) {
+        template <typename TContainer, typename T> void input_scalar_fields(const GUIManagerID& id, std::string_view name, TContainer* val, size_t elemCount, T min, T max, FunctionRef<void()> elemUpdate = nullptr) {
             push_id(id);
             left_to_right_line_layout([&]() {
                 text_label(name);
                 for(size_t i = 0; i < elemCount; i++)
-                    input_scalar<T>(std::to_string(i), &(*val)[i], min, max, elemUpdate);
+                    input_scalar<T>(static_cast<int64_t>(i), &(*val)[i], min, max, elemUpdate);
             });
             pop_id();
         }
 
-        template <typename T> void input_color_hex(const std::string& id, T* val, bool selectAlpha, const std::function<void()>& elemUpdate = nullptr) {
-            input_generic<T>(id, val, 
-                [&](const std::string& str) {
-                    T def = {0.0f, 0.0f, 0.0f, 1.0f};
-                    unsigned startIndex = 0;
-                    if(str.empty())
-                        return def;
-
-                    if(str[0] == '#')
-                        startIndex++;
-
-                    for(unsigned i = 0; i < (selectAlpha ? 4 : 3); i++) {
-                        int byteColor;
-                        std::stringstream ss;
-                        size_t startingAt = startIndex + i * 2;
-                        if(startingAt + 1 >= str.size())
-                            break;
-                        ss << str.substr(startingAt, 2);
-                        ss >> std::hex >> byteColor;
-                        if(ss.fail())
-                            break;
-                        def[i] = byteColor / 255.0f;
-                    }
-                    return def;
-                }, 
-                [&](const T& color) {
-                    std::stringstream ss;
-                    ss << "#" << std::setfill('0') << std::setw(2) << std::hex;
-                    for(size_t i = 0; i < (selectAlpha ? 4 : 3); i++) {
-                        int convertTo255 = static_cast<int>(std::clamp<float>(color[i], 0, 1) * 255);
-                        ss << std::setfill('0') << std::setw(2) << std::hex << convertTo255;
-                    }
-                    return ss.str();
-                },
-                true, elemUpdate);
+        template <typename T> void input_color_hex(const GUIManagerID& id, T* val, bool selectAlpha, FunctionRef<void()> elemUpdate = nullptr) {
+            input_codec(id, val, HexColorCodec<T>{selectAlpha}, true, elemUpdate);
         }
 
-        template <typename T> void color_picker(const std::string& id, T* val, bool selectAlpha, const std::function<void()>& elemUpdate = nullptr) {
+        template <typename T> void color_picker(const GUIManagerID& id, T* val, bool selectAlpha, FunctionRef<void()> elemUpdate = nullptr) {
+            watch_value(val);
             push_id(id);
             insert_element<ColorPicker<T>>()->update(*io, val, selectAlpha, elemUpdate);
             pop_id();
         }
 
-        template <typename T> void slider_scalar(const std::string& id, T* val, T min, T max, const std::function<void()>& elemUpdate = nullptr) {
+        template <typename T> void slider_scalar(const GUIManagerID& id, T* val, T min, T max, FunctionRef<void()> elemUpdate = nullptr) {
+            watch_value(val);
             push_id(id);
             insert_element<NumberSlider<T>>()->update(*io, val, min, max, elemUpdate); 
             pop_id();
         }
 
-        template <typename T> void input_scalar_field(const std::string& id, const std::string& name, T* val, T min, T max, const std::function<void()>& elemUpdate = nullptr) {
+        template <typename T> void input_scalar_field(const GUIManagerID& id, std::string_view name, T* val, T min, T max, FunctionRef<void()> elemUpdate = nullptr) {
             left_to_right_line_layout([&]() {
                 text_label(name);
                 input_scalar(id, val, min, max, elemUpdate);
             });
         }
 
-        template <typename T> void slider_scalar_field(const std::string& id, const std::string& name, T* val, T min, T max, const std::function<void()>& elemUpdate = nullptr) {
+        template <typename T> void slider_scalar_field(const GUIManagerID& id, std::string_view name, T* val, T min, T max, FunctionRef<void()> elemUpdate = nullptr) {
             push_id(id);
             left_to_right_line_layout([&]() {
                 text_label(name);
-                input_scalar("0", val, min, max, elemUpdate);
+                input_scalar("0"_id, val, min, max, elemUpdate);
             });
-            slider_scalar("1", val, min, max, elemUpdate);
+            slider_scalar("1"_id, val, min, max, elemUpdate);
             pop_id();
         }
 
-        template <typename T> bool color_button(const std::string& id, T* val, bool isSelected = false, const std::function<void()>& elemUpdate = nullptr) {
+        template <typename T> bool color_button(const GUIManagerID& id, T* val, bool isSelected = false, FunctionRef<void()> elemUpdate = nullptr) {
             return selectable_button(id, [&](SelectionHelper& s, bool iS) {
                 CLAY({.layout = { 
                         .sizing = {.width = CLAY_SIZING_GROW(0), .height = CLAY_SIZING_GROW(0)},
@@ -219,18 +290,18 @@ class GUIManager {
             }, true, false, isSelected);
         }
 
-        template <typename T> void color_picker_button(const std::string& id, T* val, bool selectAlpha, const std::function<void()>& elemUpdate = nullptr) {
+        template <typename T> void color_picker_button(const GUIManagerID& id, T* val, bool selectAlpha, FunctionRef<void()> elemUpdate = nullptr) {
             push_id(id);
             bool& isOpen = insert_any_with_id<bool>(0, false);
             bool clicked;
             CLAY ({.layout = {.sizing = {.width = CLAY_SIZING_FIXED(40), .height = CLAY_SIZING_FIXED(40) } } }) {
-                clicked = color_button("0", val, elemUpdate);
+                clicked = color_button("0"_id, val, false, elemUpdate);
             }
             if(clicked)
                 isOpen = true;
             if(isOpen) {
                 top_to_bottom_window_popup_layout(CLAY_SIZING_FIXED(300), CLAY_SIZING_FIT(0), [&]() {
-                    color_picker_items("c", val, false, selectAlpha);
+                    color_picker_items("c"_id, val, false, selectAlpha);
                     if(io->mouse.leftClick && !Clay_Hovered() && !clicked)
                         isOpen = false;
                 });
@@ -238,35 +309,35 @@ class GUIManager {
             pop_id();
         }
 
-        template <typename T> void color_picker_items(const std::string& id, T* val, bool selectAlpha) {
+        template <typename T> void color_picker_items(const GUIManagerID& id, T* val, bool selectAlpha) {
             push_id(id);
-            color_picker("c", val, selectAlpha);
+            color_picker("c"_id, val, selectAlpha);
             left_to_right_line_layout([&]() {
-                text_label("Red");
-                input_color_component_255("r", &(*val)[0]);
+                text_label("Red"_lbl);
+                input_color_component_255("r"_id, &(*val)[0]);
             });
             left_to_right_line_layout([&]() {
-                text_label("Green");
-                input_color_component_255("g", &(*val)[1]);
+                text_label("Green"_lbl);
+                input_color_component_255("g"_id, &(*val)[1]);
             });
             left_to_right_line_layout([&]() {
-                text_label("Blue");
-                input_color_component_255("b", &(*val)[2]);
+                text_label("Blue"_lbl);
+                input_color_component_255("b"_id, &(*val)[2]);
             });
             if(selectAlpha) {
                 left_to_right_line_layout([&]() {
-                    text_label("Alpha");
-                    input_color_component_255("a", &(*val)[3]);
+                    text_label("Alpha"_lbl);
+                    input_color_component_255("a"_id, &(*val)[3]);
                 });
             }
             left_to_right_line_layout([&]() {
-                text_label("Hex");
-                input_color_hex("h", val, selectAlpha);
+                text_label("Hex"_lbl);
+                input_color_hex("h"_id, val, selectAlpha);
             });
             pop_id();
         }
 
-        template <typename T> void color_picker_button_field(const std::string& id, const std::string& name, T* val, bool selectAlpha, const std::function<void()>& elemUpdate = nullptr) {
+        template <typename T> void color_picker_button_field(const GUIManagerID& id, std::string_view name, T* val, bool selectAlpha, FunctionRef<void()> elemUpdate = nullptr) {
             left_to_right_line_layout([&]() {
                 color_picker_button(id, val, selectAlpha, elemUpdate);
                 text_label(name);
@@ -274,14 +345,120 @@ class GUIManager {
         }
 
     private:
+        template <typename T> SlabPool<T>& get_pool() {
+            size_t i = slab_pool_type_index<T>();
+            if(i >= pools.size())
+                pools.resize(i + 1);
+            if(!pools[i])
+                pools[i] = std::make_unique<SlabPool<T>>();
+            return static_cast<SlabPool<T>&>(*pools[i]);
+        }
+
+        // Values bound through pointers this frame. Their hashes are taken on end(), and compared by needs_update.
+        // The pointers are dropped by request_update and begin, so they're never read after either
+        struct WatchedValue {
+            const void* val;
+            uint64_t (*hash)(const void* val);
+            uint64_t lastHash;
+        };
+
+        // Fixed size Eigen vectors and matrices (such as colors) have their own copy constructors, so they aren't trivially copyable
+        template <typename T> static constexpr bool is_fixed_size_eigen = requires { T::SizeAtCompileTime; typename T::Scalar; } && std::is_base_of_v<Eigen::DenseBase<T>, T>;
+
+        // Only types without padding bits are hashed by their bytes. Fixed size Eigen types are hashed by their coefficients
+        template <typename T> static uint64_t watched_value_hash(const void* val) {
+            if constexpr(std::has_unique_object_representations_v<T>)
+                return guimanager_id_str_hash(std::string_view(static_cast<const char*>(val), sizeof(T)));
+            else if constexpr(is_fixed_size_eigen<T>)
+                return guimanager_id_str_hash(std::string_view(reinterpret_cast<const char*>(static_cast<const T*>(val)->data()), sizeof(typename T::Scalar) * T::SizeAtCompileTime));
+            else
+                return std::hash<T>{}(*static_cast<const T*>(val));
+        }
+
+        template <typename T> void watch_value(const T* val) {
+            if constexpr(is_fixed_size_eigen<T>)
+                static_assert(T::SizeAtCompileTime != Eigen::Dynamic && std::is_arithmetic_v<typename T::Scalar>, "[GUIManager::watch_value] Only fixed size Eigen types with arithmetic coefficients can be watched");
+            else
+                static_assert(std::has_unique_object_representations_v<T> || requires(const T& v) { std::hash<T>{}(v); }, "[GUIManager::watch_value] Bound values need to have no padding bits, be a fixed size Eigen type, or have a std::hash specialization");
+            if(val)
+                watchedValues.push_back({val, &watched_value_hash<T>, 0});
+        }
+
+        bool input_pending() const;
+
+        std::vector<WatchedValue> watchedValues;
+        bool updateRequested = true;
+        bool redrawPending = false;
+        Vector2f lastMouseGlobalPos = Vector2f{0.0f, 0.0f};
+        Vector2f lastWindowPos = Vector2f{0.0f, 0.0f};
+        Vector2f lastWindowSize = Vector2f{0.0f, 0.0f};
+
+        // Indexed by slab_pool_type_index, null for types this manager never stored. Pools keep their chunks, so their memory stays at its
+        // peak and is reused when the same panels are opened again
+        std::vector<std::unique_ptr<SlabPoolBase>> pools;
+
+        void evict_stale_elements();
+        size_t pool_live_bytes() const;
+
+        uint64_t frameCounter = 0;
+        std::optional<GUIManagerIDStack> evictionCursor; // The next element to check, or none to start from the beginning
+        EvictionStats evictionStats;
+
+        struct InternedStyle {
+            StyleBuilder builder;
+            Clay_ElementDeclaration declaration;
+        };
+
+        void resolve_styles();
+
+        std::vector<InternedStyle> styles;
+        std::shared_ptr<Theme> stylesTheme; // Theme that styles were last built from. Held so that its address isn't reused
+        Clay_TextElementConfig labelTextConfig; // Shared by every text_label, so Clay doesn't store a copy per label
+
+        void initialize_clay();
+        void grow_clay_capacity();
+
         static void clay_error_handler(Clay_ErrorData errorData);
         static Clay_Dimensions clay_skia_measure_text(Clay_StringSlice str, Clay_TextElementConfig* config, void* userData);
 
-        DefaultStringArena strArena;
+        Clay_String id_to_clay_str(const GUIManagerID& id);
+
+        size_t draw_text_commands(SkCanvas* canvas, size_t start); // Returns how many render commands were drawn
+        static SkColor4f clay_color_to_sk(const Clay_Color& c);
+        static SkRRect make_rrect(const SkRect& rect, const Clay_CornerRadius& radius, float radiusOffset); // radiusOffset is added to corners that are rounded
 
-        Clay_Context* clayInstance;
-        Clay_Arena clayArena;
+        void text_label_clay_str(const Clay_String& str);
+        void text_label_centered_clay_str(const Clay_String& str);
+
+        static Clay_String static_label_to_clay_str(StaticLabel val) {
+            return Clay_String{.length = static_cast<int32_t>(val.str.size()), .chars = val.str.data()};
+        }
+
+        // args are lvalues here, which fmt wasn't checked against, so they're formatted through the type erased functions
+        template <typename... Args> Clay_String format_to_clay_str(std::format_string<Args...> fmt, Args&&... args) {
+            formatBuffer.clear();
+            std::vformat_to(std::back_inserter(formatBuffer), fmt.get(), std::make_format_args(args...));
+            return strArena.std_str_to_clay_str(formatBuffer);
+        }
+
+        DefaultStringArena strArena;
+        std::string formatBuffer; // Kept between calls to format_to_clay_str, so formatting doesn't allocate once it's grown
+        TextMeasureCache textMeasureCache;
+        TextBlobCache textBlobCache;
+        SkTextBlobBuilder textBatchBuilder;
+        SkPaint fillPaint; // Reused by draw for every rectangle, border and text command, only the color changes
+        FrameArena frameArena;
+
+        Clay_Context* clayInstance = nullptr;
+        Clay_Arena clayArena = {};
+        bool clayElementCapacityExceeded = false;
+        bool clayWordCapacityExceeded = false;
+        ClayCapacityStats clayStats;
         Clay_RenderCommandArray renderCommands;
+        RenderCommandOptimizerStats renderOptimizerStats;
+        DamageTracker damageTracker;
+        std::vector<Clay_RenderCommand> optimizedCommands;
+        std::span<Clay_RenderCommand> drawCommands; // Either renderCommands or optimizedCommands, what draw() goes through
 };
 
 }
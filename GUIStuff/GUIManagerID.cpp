@@ -4,16 +4,50 @@ namespace GUIStuff {
 
 GUIManagerID::GUIManagerID(int64_t numID):
     idIsStr(false),
-    idNum(numID)
+    idNum(numID),
+    idHash(std::hash<uint64_t>{}(numID))
 {}
 
 GUIManagerID::GUIManagerID(const std::string& strID):
     idIsStr(true),
-    idStr(strID)
+    idStr(strID),
+    idHash(guimanager_id_str_hash(strID))
+{}
+
+GUIManagerID::GUIManagerID(const char* strID):
+    GUIManagerID(std::string(strID))
 {}
 
 bool GUIManagerID::operator==(const GUIManagerID& other) const {
-    return idIsStr == other.idIsStr && idStr == other.idStr && idNum == other.idNum;
+    return idHash == other.idHash && idIsStr == other.idIsStr && idNum == other.idNum && str() == other.str();
+}
+
+void GUIManagerIDStack::push(const GUIManagerID& id) {
+    uint64_t h = prefixHashes.empty() ? 0 : prefixHashes.back();
+    hash_combine(h, id);
+    ids.emplace_back(id);
+    prefixHashes.emplace_back(h);
+}
+
+void GUIManagerIDStack::pop() {
+    ids.pop_back();
+    prefixHashes.pop_back();
+}
+
+bool GUIManagerIDStack::empty() const {
+    return ids.empty();
+}
+
+size_t GUIManagerIDStack::size() const {
+    return ids.size();
+}
+
+uint64_t GUIManagerIDStack::hash() const {
+    return prefixHashes.empty() ? 0 : prefixHashes.back();
+}
+
+bool GUIManagerIDStack::operator==(const GUIManagerIDStack& other) const {
+    return hash() == other.hash() && ids == other.ids;
 }
 
 }
@@ -1,40 +1,84 @@
 #pragma once
 #include <stack>
+#include <string_view>
 #include <Helpers/Hashes.hpp>
 
 namespace GUIStuff {
 
+constexpr uint64_t guimanager_id_str_hash(std::string_view str) {
+    // FNV-1a, usable at compile time so that literal IDs are hashed by the compiler
+    uint64_t h = 14695981039346656037ull;
+    for(char c : str) {
+        h ^= static_cast<uint8_t>(c);
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+// ID whose string lives in static storage and whose hash was computed at compile time.
+// Create using the _id literal, ex. gui.text_button_wide("save file"_id, "Save")
+struct GUIManagerStaticID {
+    std::string_view str;
+    uint64_t hash;
+};
+
+inline namespace IDLiterals {
+    consteval GUIManagerStaticID operator""_id(const char* str, size_t len) {
+        return GUIManagerStaticID{std::string_view(str, len), guimanager_id_str_hash(std::string_view(str, len))};
+    }
+}
+
 struct GUIManagerID {
     GUIManagerID() = default;
     GUIManagerID(int64_t numID);
     GUIManagerID(const std::string& strID);
+    GUIManagerID(const char* strID);
+    GUIManagerID(GUIManagerStaticID staticID):
+        idIsStr(true),
+        idIsStatic(true),
+        idStaticStr(staticID.str),
+        idHash(staticID.hash)
+    {}
     bool operator==(const GUIManagerID& other) const;
+    std::string_view str() const {
+        return idIsStatic ? idStaticStr : std::string_view(idStr);
+    }
 
-    bool idIsStr;
+    bool idIsStr = false;
+    bool idIsStatic = false; // String is stored in idStaticStr and not owned, used for literal IDs
     std::string idStr;
+    std::string_view idStaticStr;
     int64_t idNum = 0;
+    uint64_t idHash = 0; // Computed once on construction, so the stack doesn't rehash strings on every lookup
 };
 
-typedef std::vector<GUIManagerID> GUIManagerIDStack;
+// Stack of IDs that keeps a rolling hash of every prefix, so that push/pop are O(1) to hash
+// and looking up an element doesn't require copying or rehashing the whole stack
+class GUIManagerIDStack {
+    public:
+        void push(const GUIManagerID& id);
+        void pop();
+        bool empty() const;
+        size_t size() const;
+        uint64_t hash() const;
+        bool operator==(const GUIManagerIDStack& other) const;
+    private:
+        std::vector<GUIManagerID> ids;
+        std::vector<uint64_t> prefixHashes;
+};
 
 }
 
 template <> struct std::hash<GUIStuff::GUIManagerID> {
     size_t operator()(const GUIStuff::GUIManagerID& v) const
     {
-        if(v.idIsStr)
-            return std::hash<std::string>{}(v.idStr);
-        else
-            return std::hash<uint64_t>{}(v.idNum);
+        return v.idHash;
     }
 };
 
 template <> struct std::hash<GUIStuff::GUIManagerIDStack> {
     size_t operator()(const GUIStuff::GUIManagerIDStack& v) const
     {
-        uint64_t h = 0;
-        for(const auto& i : v)
-            hash_combine(h, i);
-        return h;
+        return v.hash();
     }
 };
@@ -0,0 +1,199 @@
+#include "RenderCommandOptimizer.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace GUIStuff {
+
+namespace {
+    // Opaque rectangles smaller than this aren't used to hide other commands, since they rarely cover anything
+    constexpr float MIN_OCCLUDER_AREA = 64.0f * 64.0f;
+    // Only the largest occluders are tested against, so each command is checked against at most this many
+    constexpr size_t MAX_OCCLUDERS = 8;
+    // Text and custom elements can draw slightly past their bounding box (such as glyph overhang), so they need to be covered by this much more
+    constexpr float OCCLUSION_MARGIN = 4.0f;
+
+    struct Rect {
+        float left, top, right, bottom;
+
+        static Rect from_bb(const Clay_BoundingBox& bb) {
+            return {bb.x, bb.y, bb.x + bb.width, bb.y + bb.height};
+        }
+        Rect intersect(const Rect& o) const {
+            return {std::max(left, o.left), std::max(top, o.top), std::min(right, o.right), std::min(bottom, o.bottom)};
+        }
+        Rect outset(float amount) const {
+            return {left - amount, top - amount, right + amount, bottom + amount};
+        }
+        bool empty() const {
+            return left >= right || top >= bottom;
+        }
+        bool contains(const Rect& o) const {
+            return o.left >= left && o.top >= top && o.right <= right && o.bottom <= bottom;
+        }
+        float area() const {
+            return empty() ? 0.0f : (right - left) * (bottom - top);
+        }
+    };
+
+    struct Occluder {
+        size_t index;
+        Rect rect;
+    };
+
+    bool is_drawing_command(const Clay_RenderCommand& c) {
+        return c.commandType == CLAY_RENDER_COMMAND_TYPE_RECTANGLE || c.commandType == CLAY_RENDER_COMMAND_TYPE_BORDER || c.commandType == CLAY_RENDER_COMMAND_TYPE_TEXT || c.commandType == CLAY_RENDER_COMMAND_TYPE_IMAGE || c.commandType == CLAY_RENDER_COMMAND_TYPE_CUSTOM;
+    }
+
+    bool is_transparent(const Clay_RenderCommand& c) {
+        switch(c.commandType) {
+            case CLAY_RENDER_COMMAND_TYPE_RECTANGLE:
+                return c.renderData.rectangle.backgroundColor.a <= 0.0f;
+            case CLAY_RENDER_COMMAND_TYPE_BORDER:
+                return c.renderData.border.color.a <= 0.0f;
+            case CLAY_RENDER_COMMAND_TYPE_TEXT:
+                return c.renderData.text.textColor.a <= 0.0f;
+            default:
+                return false;
+        }
+    }
+
+    // Borders are centered on the edge of the bounding box, so half of their width is drawn outside it
+    Rect drawn_rect(const Clay_RenderCommand& c) {
+        Rect toRet = Rect::from_bb(c.boundingBox);
+        if(c.commandType == CLAY_RENDER_COMMAND_TYPE_BORDER) {
+            const Clay_BorderWidth& w = c.renderData.border.width;
+            toRet = toRet.outset(std::max({w.left, w.right, w.top, w.bottom}) * 0.5f);
+        }
+        return toRet;
+    }
+
+    bool has_rounded_corners(const Clay_CornerRadius& r) {
+        return r.topLeft > 0.0f || r.topRight > 0.0f || r.bottomLeft > 0.0f || r.bottomRight > 0.0f;
+    }
+
+    // The part of an opaque rectangle that's guaranteed to be fully covered, taking rounded corners out
+    Rect opaque_area(const Clay_RenderCommand& c, const Rect& clip) {
+        const Clay_CornerRadius& r = c.renderData.rectangle.cornerRadius;
+        float maxRadius = std::max({r.topLeft, r.topRight, r.bottomLeft, r.bottomRight});
+        Rect toRet = Rect::from_bb(c.boundingBox).intersect(clip);
+        // Insetting by the radius on just one axis keeps the rounded corners out of the area
+        if(maxRadius > 0.0f)
+            toRet = {toRet.left, toRet.top + maxRadius, toRet.right, toRet.bottom - maxRadius};
+        return toRet;
+    }
+
+    bool try_merge_rectangles(Clay_RenderCommand& a, const Clay_RenderCommand& b) {
+        if(a.commandType != CLAY_RENDER_COMMAND_TYPE_RECTANGLE || b.commandType != CLAY_RENDER_COMMAND_TYPE_RECTANGLE)
+            return false;
+        const Clay_RectangleRenderData& ra = a.renderData.rectangle;
+        const Clay_RectangleRenderData& rb = b.renderData.rectangle;
+        if(has_rounded_corners(ra.cornerRadius) || has_rounded_corners(rb.cornerRadius))
+            return false;
+        if(ra.backgroundColor.r != rb.backgroundColor.r || ra.backgroundColor.g != rb.backgroundColor.g || ra.backgroundColor.b != rb.backgroundColor.b || ra.backgroundColor.a != rb.backgroundColor.a)
+            return false;
+        // Translucent rectangles that overlap would look different merged, so only merge rectangles that touch exactly
+        Clay_BoundingBox& ba = a.boundingBox;
+        const Clay_BoundingBox& bb = b.boundingBox;
+        if(ba.y == bb.y && ba.height == bb.height) {
+            if(ba.x + ba.width == bb.x) {
+                ba.width += bb.width;
+                return true;
+            }
+            if(bb.x + bb.width == ba.x) {
+                ba.x = bb.x;
+                ba.width += bb.width;
+                return true;
+            }
+        }
+        if(ba.x == bb.x && ba.width == bb.width) {
+            if(ba.y + ba.height == bb.y) {
+                ba.height += bb.height;
+                return true;
+            }
+            if(bb.y + bb.height == ba.y) {
+                ba.y = bb.y;
+                ba.height += bb.height;
+                return true;
+            }
+        }
+        return false;
+    }
+}
+
+RenderCommandOptimizerStats optimize_render_commands(const Clay_RenderCommandArray& commands, std::vector<Clay_RenderCommand>& out) {
+    RenderCommandOptimizerStats stats;
+    size_t count = static_cast<size_t>(commands.length);
+    stats.commandsIn = count;
+    out.clear();
+    out.reserve(count);
+
+    constexpr float INF = std::numeric_limits<float>::infinity();
+    std::vector<Rect> clipStack{Rect{-INF, -INF, INF, INF}};
+    std::vector<Rect> visibleRects(count); // The part of each command inside its scissor rect
+    std::vector<Occluder> occluders;
+
+    for(size_t i = 0; i < count; i++) {
+        const Clay_RenderCommand& c = commands.internalArray[i];
+        if(c.commandType == CLAY_RENDER_COMMAND_TYPE_SCISSOR_START)
+            clipStack.emplace_back(clipStack.back().intersect(Rect::from_bb(c.boundingBox)));
+        else if(c.commandType == CLAY_RENDER_COMMAND_TYPE_SCISSOR_END) {
+            if(clipStack.size() > 1)
+                clipStack.pop_back();
+        }
+        visibleRects[i] = drawn_rect(c).intersect(clipStack.back());
+        if(c.commandType == CLAY_RENDER_COMMAND_TYPE_RECTANGLE && c.renderData.rectangle.backgroundColor.a >= 1.0f) {
+            Rect opaque = opaque_area(c, clipStack.back());
+            if(opaque.area() >= MIN_OCCLUDER_AREA)
+                occluders.push_back({i, opaque});
+        }
+    }
+
+    // The largest opaque rectangles (window backgrounds and panels) hide almost everything that gets hidden,
+    // so the rest are dropped to keep the test per command constant
+    if(occluders.size() > MAX_OCCLUDERS) {
+        std::nth_element(occluders.begin(), occluders.begin() + MAX_OCCLUDERS, occluders.end(), [](const Occluder& a, const Occluder& b) {
+            return a.rect.area() > b.rect.area();
+        });
+        occluders.resize(MAX_OCCLUDERS);
+        std::sort(occluders.begin(), occluders.end(), [](const Occluder& a, const Occluder& b) {
+            return a.index < b.index;
+        });
+    }
+
+    size_t firstLaterOccluder = 0;
+    for(size_t i = 0; i < count; i++) {
+        const Clay_RenderCommand& c = commands.internalArray[i];
+        // Custom elements save their bounding box and advance their animations in clay_draw, so they're never dropped
+        if(is_drawing_command(c) && c.commandType != CLAY_RENDER_COMMAND_TYPE_CUSTOM) {
+            if(is_transparent(c)) {
+                stats.transparentDropped++;
+                continue;
+            }
+            if(visibleRects[i].empty()) {
+                stats.culledDropped++;
+                continue;
+            }
+            while(firstLaterOccluder < occluders.size() && occluders[firstLaterOccluder].index <= i)
+                firstLaterOccluder++;
+            Rect needsCover = visibleRects[i].outset(OCCLUSION_MARGIN);
+            bool occluded = std::any_of(occluders.begin() + firstLaterOccluder, occluders.end(), [&](const Occluder& o) {
+                return o.rect.contains(needsCover);
+            });
+            if(occluded) {
+                stats.occludedDropped++;
+                continue;
+            }
+            if(!out.empty() && try_merge_rectangles(out.back(), c)) {
+                stats.rectanglesMerged++;
+                continue;
+            }
+        }
+        out.emplace_back(c);
+    }
+
+    stats.commandsOut = out.size();
+    return stats;
+}
+
+}
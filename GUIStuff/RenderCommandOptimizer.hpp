@@ -0,0 +1,27 @@
+#pragma once
+#include <vector>
+#include <cstddef>
+
+#pragma GCC diagnostic push 
+#pragma GCC diagnostic ignored "-Wunused-variable"
+#include <clay.h>
+#pragma GCC diagnostic pop
+
+namespace GUIStuff {
+
+struct RenderCommandOptimizerStats {
+    size_t commandsIn = 0;
+    size_t commandsOut = 0;
+    size_t transparentDropped = 0;
+    size_t culledDropped = 0;
+    size_t occludedDropped = 0;
+    size_t rectanglesMerged = 0;
+};
+
+// Copies commands into out, leaving out commands that wouldn't change any pixels:
+// fully transparent commands, commands outside the scissor rect they're in, and commands under a later opaque rectangle.
+// Consecutive square rectangles of the same color that share a whole edge are merged into one.
+// Custom commands are always kept, since elements update their bounding box and animations in clay_draw
+RenderCommandOptimizerStats optimize_render_commands(const Clay_RenderCommandArray& commands, std::vector<Clay_RenderCommand>& out);
+
+}
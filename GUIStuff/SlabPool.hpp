@@ -0,0 +1,107 @@
+#pragma once
+#include <vector>
+#include <memory>
+#include <cstddef>
+#include <algorithm>
+#include <new>
+
+namespace GUIStuff {
+
+inline size_t next_slab_pool_type_index() {
+    static size_t counter = 0;
+    return counter++;
+}
+
+// Small dense index per type, used to find a type's pool without hashing
+template <typename T> size_t slab_pool_type_index() {
+    static const size_t index = next_slab_pool_type_index();
+    return index;
+}
+
+class SlabPoolBase {
+    public:
+        virtual void destroy(void* obj) = 0;
+        virtual void reserve(size_t count) = 0;
+        virtual size_t object_size() const = 0;
+        virtual ~SlabPoolBase() = default;
+
+        // Makes sure there's room for at least as many new objects as were created last frame
+        void begin_frame() {
+            createdLastFrame = createdThisFrame;
+            createdThisFrame = 0;
+            reserve(liveCount + createdLastFrame);
+        }
+
+        size_t live_count() const { return liveCount; }
+        size_t capacity() const { return slotCapacity; }
+        size_t created_last_frame() const { return createdLastFrame; }
+
+    protected:
+        size_t liveCount = 0;
+        size_t slotCapacity = 0;
+        size_t createdThisFrame = 0;
+        size_t createdLastFrame = 0;
+};
+
+// Stores objects of a single type in contiguous chunks. Pointers stay valid until the object is destroyed.
+// The pool does not track which slots are alive, so the owner must destroy every object it created before the pool is destroyed.
+// Chunks are only freed with the pool, so its memory stays at the most objects it has held at once
+template <typename T> class SlabPool : public SlabPoolBase {
+    public:
+        SlabPool() = default;
+        SlabPool(const SlabPool&) = delete;
+        SlabPool& operator=(const SlabPool&) = delete;
+
+        template <typename... Args> T* create(Args&&... args) {
+            if(!freeList)
+                grow(std::max<size_t>(MIN_CHUNK_SIZE, slotCapacity));
+            Slot* s = freeList;
+            freeList = s->next;
+            T* obj = new (s->storage) T(std::forward<Args>(args)...);
+            liveCount++;
+            createdThisFrame++;
+            return obj;
+        }
+
+        virtual void destroy(void* obj) override {
+            static_cast<T*>(obj)->~T();
+            Slot* s = reinterpret_cast<Slot*>(obj);
+            s->next = freeList;
+            freeList = s;
+            liveCount--;
+        }
+
+        virtual void reserve(size_t count) override {
+            // Grow geometrically like create does, so that small per-frame shortfalls don't add many tiny chunks
+            if(count > slotCapacity)
+                grow(std::max({MIN_CHUNK_SIZE, count - slotCapacity, slotCapacity}));
+        }
+
+        virtual size_t object_size() const override {
+            return sizeof(T);
+        }
+
+    private:
+        static constexpr size_t MIN_CHUNK_SIZE = 32;
+
+        union Slot {
+            Slot* next;
+            alignas(T) std::byte storage[sizeof(T)];
+        };
+
+        void grow(size_t slotCount) {
+            chunks.emplace_back(std::make_unique<Slot[]>(slotCount));
+            Slot* chunk = chunks.back().get();
+            // Link in reverse so that objects are handed out in address order
+            for(size_t i = slotCount; i-- > 0;) {
+                chunk[i].next = freeList;
+                freeList = &chunk[i];
+            }
+            slotCapacity += slotCount;
+        }
+
+        std::vector<std::unique_ptr<Slot[]>> chunks;
+        Slot* freeList = nullptr;
+};
+
+}
@@ -0,0 +1,48 @@
+#include "TextBlobCache.hpp"
+#include "include/core/SkFontMetrics.h"
+
+namespace GUIStuff {
+
+TextBlobCache::TextBlobCache(size_t maxEntries):
+    cache(maxEntries)
+{}
+
+TextBlobCache::SizeData::SizeData(const SkFont& font):
+    font(font)
+{
+    SkFontMetrics metrics;
+    font.getMetrics(&metrics);
+    descent = metrics.fDescent;
+}
+
+const TextBlobCache::Blob& TextBlobCache::get(std::string_view str, uint16_t fontSize, const Theme& theme) {
+    return cache.get(str, fontSize, theme, make_blob);
+}
+
+void TextBlobCache::clear() {
+    cache.clear();
+}
+
+size_t TextBlobCache::size() const {
+    return cache.size();
+}
+
+TextBlobCache::Blob TextBlobCache::make_blob(std::string_view str, const SizeData& sizeData) {
+    Blob blob;
+    blob.descent = sizeData.descent;
+    blob.font = &sizeData.font;
+    blob.glyphs.resize(sizeData.font.countText(str.data(), str.size(), SkTextEncoding::kUTF8));
+    sizeData.font.textToGlyphs(str.data(), str.size(), SkTextEncoding::kUTF8, blob.glyphs.data(), blob.glyphs.size());
+    blob.xPositions.resize(blob.glyphs.size());
+    sizeData.font.getXPos(blob.glyphs.data(), blob.glyphs.size(), blob.xPositions.data());
+    if(!blob.glyphs.empty()) {
+        SkTextBlobBuilder builder;
+        const SkTextBlobBuilder::RunBuffer& run = builder.allocRunPosH(sizeData.font, blob.glyphs.size(), 0.0f);
+        std::copy(blob.glyphs.begin(), blob.glyphs.end(), run.glyphs);
+        std::copy(blob.xPositions.begin(), blob.xPositions.end(), run.pos);
+        blob.blob = builder.make();
+    }
+    return blob;
+}
+
+}
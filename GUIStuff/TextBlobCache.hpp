@@ -0,0 +1,38 @@
+#pragma once
+#include "TextCache.hpp"
+#include "include/core/SkTextBlob.h"
+#include <string_view>
+#include <vector>
+
+namespace GUIStuff {
+
+// Keeps text blobs for drawn strings across frames, so that text that doesn't change is only converted to glyphs once
+class TextBlobCache {
+    public:
+        struct Blob {
+            sk_sp<SkTextBlob> blob; // Positioned with the baseline at y = 0
+            float descent;
+            // Kept so that blobs can be merged into one multi-run blob
+            const SkFont* font;
+            std::vector<SkGlyphID> glyphs;
+            std::vector<SkScalar> xPositions;
+        };
+
+        TextBlobCache(size_t maxEntries = 2048);
+        const Blob& get(std::string_view str, uint16_t fontSize, const Theme& theme);
+        void clear();
+
+        size_t size() const;
+    private:
+        struct SizeData {
+            explicit SizeData(const SkFont& font);
+            SkFont font;
+            float descent;
+        };
+
+        static Blob make_blob(std::string_view str, const SizeData& sizeData);
+
+        TextCache<Blob, SizeData> cache;
+};
+
+}
@@ -0,0 +1,102 @@
+#pragma once
+#include "Elements/Element.hpp"
+#include "GUIManagerID.hpp"
+#include <list>
+#include <unordered_map>
+#include <string>
+#include <string_view>
+
+namespace GUIStuff {
+
+// Values made from a string at a font size of the theme's typeface, kept across frames.
+// Least recently used values are evicted past maxEntries, and everything is cleared when the theme's typeface changes.
+// SizeData is built once per font size from the font, ex. for metrics, and has to be constructible from an SkFont
+template <typename Value, typename SizeData> class TextCache {
+    public:
+        TextCache(size_t maxEntries):
+            maxEntries(maxEntries)
+        {}
+
+        // Returns the cached value, or the value returned by make(str, sizeData) if there isn't one
+        template <typename MakeValue> Value& get(std::string_view str, uint16_t fontSize, const Theme& theme, MakeValue&& make) {
+            check_typeface(theme);
+
+            uint64_t key = guimanager_id_str_hash(str);
+            hash_combine(key, fontSize);
+            hash_combine(key, typeface ? typeface->uniqueID() : 0);
+
+            auto it = entries.find(key);
+            if(it != entries.end()) {
+                Entry& e = *it->second;
+                if(e.fontSize == fontSize && e.str == str) {
+                    hitCount++;
+                    lru.splice(lru.begin(), lru, it->second);
+                    return e.value;
+                }
+                // Hash collision, replace the old entry
+                lru.erase(it->second);
+                entries.erase(it);
+            }
+
+            missCount++;
+            Value value = make(str, size_data(fontSize, theme));
+            lru.emplace_front(Entry{key, fontSize, std::string(str), std::move(value)});
+            entries.emplace(key, lru.begin());
+            while(lru.size() > maxEntries) {
+                entries.erase(lru.back().key);
+                lru.pop_back();
+            }
+            return lru.front().value;
+        }
+
+        SizeData& size_data(uint16_t fontSize, const Theme& theme) {
+            check_typeface(theme);
+            auto it = sizes.find(fontSize);
+            if(it != sizes.end())
+                return it->second;
+            return sizes.emplace(fontSize, SizeData(theme.get_font(fontSize))).first->second;
+        }
+
+        void clear() {
+            lru.clear();
+            entries.clear();
+            sizes.clear();
+        }
+
+        size_t size() const {
+            return lru.size();
+        }
+
+        size_t hits() const {
+            return hitCount;
+        }
+
+        size_t misses() const {
+            return missCount;
+        }
+
+        size_t maxEntries;
+    private:
+        struct Entry {
+            uint64_t key;
+            uint16_t fontSize;
+            std::string str;
+            Value value;
+        };
+
+        void check_typeface(const Theme& theme) {
+            if(typeface != theme.textTypeface) {
+                clear();
+                typeface = theme.textTypeface;
+            }
+        }
+
+        std::list<Entry> lru; // Most recently used at the front
+        std::unordered_map<uint64_t, typename std::list<Entry>::iterator> entries;
+        std::unordered_map<uint16_t, SizeData> sizes;
+        sk_sp<SkTypeface> typeface; // Kept alive so that a new typeface can't reuse its address
+        size_t hitCount = 0;
+        size_t missCount = 0;
+};
+
+}
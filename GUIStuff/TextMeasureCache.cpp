@@ -0,0 +1,113 @@
+#include "TextMeasureCache.hpp"
+#include "include/core/SkFontMetrics.h"
+#include <cstring>
+#include <cmath>
+
+namespace GUIStuff {
+
+TextMeasureCache::TextMeasureCache(size_t maxEntries):
+    cache(maxEntries)
+{}
+
+TextMeasureCache::SizeData::SizeData(const SkFont& font):
+    font(font)
+{
+    SkFontMetrics metrics;
+    font.getMetrics(&metrics);
+    lineHeight = -metrics.fAscent + metrics.fDescent;
+}
+
+float TextMeasureCache::measure_width(std::string_view str, uint16_t fontSize, const Theme& theme) {
+    return cache.get(str, fontSize, theme, [&](std::string_view s, SizeData& sizeData) {
+        return measure_uncached(s, sizeData);
+    });
+}
+
+float TextMeasureCache::line_height(uint16_t fontSize, const Theme& theme) {
+    return cache.size_data(fontSize, theme).lineHeight;
+}
+
+void TextMeasureCache::clear() {
+    cache.clear();
+}
+
+size_t TextMeasureCache::size() const {
+    return cache.size();
+}
+
+size_t TextMeasureCache::hits() const {
+    return cache.hits();
+}
+
+size_t TextMeasureCache::misses() const {
+    return cache.misses();
+}
+
+size_t TextMeasureCache::fast_path_mismatches() const {
+    return fastPathMismatchCount;
+}
+
+float TextMeasureCache::measure_uncached(std::string_view str, SizeData& sizeData) {
+    if(!sizeData.latin1Advances) {
+        std::array<SkUnichar, 256> codePoints;
+        std::array<SkGlyphID, 256> glyphs;
+        for(size_t i = 0; i < 256; i++)
+            codePoints[i] = static_cast<SkUnichar>(i);
+        sizeData.font.unicharsToGlyphs(codePoints.data(), 256, glyphs.data());
+        sizeData.latin1Advances.emplace();
+        sizeData.font.getWidths(glyphs.data(), 256, sizeData.latin1Advances->data());
+    }
+
+    std::optional<float> fastWidth = latin1_width(str, *sizeData.latin1Advances);
+    if(!fastWidth)
+        return sizeData.font.measureText(str.data(), str.size(), SkTextEncoding::kUTF8, nullptr);
+    if(verifyFastPath) {
+        float skiaWidth = sizeData.font.measureText(str.data(), str.size(), SkTextEncoding::kUTF8, nullptr);
+        if(std::abs(skiaWidth - *fastWidth) > fastPathTolerance) {
+            fastPathMismatchCount++;
+            return skiaWidth;
+        }
+    }
+    return *fastWidth;
+}
+
+std::optional<float> TextMeasureCache::latin1_width(std::string_view str, const std::array<float, 256>& advances) {
+    const unsigned char* s = reinterpret_cast<const unsigned char*>(str.data());
+    size_t len = str.size();
+    size_t i = 0;
+    // Four separate sums so that the additions don't depend on each other and can be pipelined
+    float sums[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+
+    while(i < len) {
+        // Check 8 bytes at a time for a high bit, and sum them straight from the table if they're all ASCII
+        if(i + 8 <= len) {
+            uint64_t word;
+            std::memcpy(&word, s + i, 8);
+            if((word & 0x8080808080808080ull) == 0) {
+                sums[0] += advances[s[i]] + advances[s[i + 4]];
+                sums[1] += advances[s[i + 1]] + advances[s[i + 5]];
+                sums[2] += advances[s[i + 2]] + advances[s[i + 6]];
+                sums[3] += advances[s[i + 3]] + advances[s[i + 7]];
+                i += 8;
+                continue;
+            }
+        }
+
+        unsigned char c = s[i];
+        if(c < 0x80) {
+            sums[0] += advances[c];
+            i++;
+        }
+        else if((c == 0xC2 || c == 0xC3) && i + 1 < len && (s[i + 1] & 0xC0) == 0x80) {
+            // Two byte UTF-8 sequences starting with C2 or C3 are the code points 0x80 to 0xFF
+            sums[0] += advances[((c & 0x1F) << 6) | (s[i + 1] & 0x3F)];
+            i += 2;
+        }
+        else
+            return std::nullopt;
+    }
+
+    return (sums[0] + sums[1]) + (sums[2] + sums[3]);
+}
+
+}
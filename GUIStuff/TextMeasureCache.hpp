@@ -0,0 +1,40 @@
+#pragma once
+#include "TextCache.hpp"
+#include <array>
+#include <optional>
+#include <string_view>
+
+namespace GUIStuff {
+
+// Remembers text widths across frames, since Clay's own measurement cache is cleared whenever layout changes
+class TextMeasureCache {
+    public:
+        TextMeasureCache(size_t maxEntries = 8192);
+        float measure_width(std::string_view str, uint16_t fontSize, const Theme& theme);
+        float line_height(uint16_t fontSize, const Theme& theme);
+        void clear();
+
+        size_t size() const;
+        size_t hits() const;
+        size_t misses() const;
+        size_t fast_path_mismatches() const;
+
+        // When set, widths from the advance table are also measured by Skia, and Skia's width is used if they differ by more than fastPathTolerance
+        bool verifyFastPath = false;
+        float fastPathTolerance = 0.01f;
+    private:
+        struct SizeData {
+            explicit SizeData(const SkFont& font);
+            SkFont font;
+            float lineHeight;
+            std::optional<std::array<float, 256>> latin1Advances; // Built the first time a Latin-1 string is measured at this size
+        };
+
+        float measure_uncached(std::string_view str, SizeData& sizeData);
+        static std::optional<float> latin1_width(std::string_view str, const std::array<float, 256>& advances);
+
+        TextCache<float, SizeData> cache;
+        size_t fastPathMismatchCount = 0;
+};
+
+}
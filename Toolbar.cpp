@@ -11,6 +11,65 @@
 #include <filesystem>
 #include <optional>
 
+using namespace GUIStuff::IDLiterals;
+
+namespace {
+    Clay_ElementDeclaration window_style(const GUIStuff::Theme& theme) {
+        return {
+            .layout = {
+                .sizing = {.width = CLAY_SIZING_FIT(300), .height = CLAY_SIZING_FIT(0) },
+                .padding = CLAY_PADDING_ALL(theme.padding1),
+                .childGap = theme.childGap1,
+                .childAlignment = { .x = CLAY_ALIGN_X_CENTER, .y = CLAY_ALIGN_Y_TOP},
+                .layoutDirection = CLAY_TOP_TO_BOTTOM
+            },
+            .backgroundColor = convert_vec4<Clay_Color>(theme.backColor1),
+            .cornerRadius = CLAY_CORNER_RADIUS(theme.windowCorners1),
+            .border = {.color = convert_vec4<Clay_Color>(theme.backColor2), .width = CLAY_BORDER_OUTSIDE(theme.windowBorders1)}
+        };
+    }
+
+    Clay_ElementDeclaration centered_window_style(const GUIStuff::Theme& theme) {
+        Clay_ElementDeclaration d = window_style(theme);
+        d.floating = {.attachPoints = {.element = CLAY_ATTACH_POINT_CENTER_CENTER, .parent = CLAY_ATTACH_POINT_CENTER_CENTER}, .attachTo = CLAY_ATTACH_TO_PARENT};
+        return d;
+    }
+
+    Clay_ElementDeclaration top_toolbar_style(const GUIStuff::Theme& theme) {
+        Clay_ElementDeclaration d = window_style(theme);
+        d.layout.sizing = {.width = CLAY_SIZING_GROW(0), .height = CLAY_SIZING_FIT(0) };
+        d.layout.childAlignment = { .x = CLAY_ALIGN_X_LEFT, .y = CLAY_ALIGN_Y_CENTER};
+        d.layout.layoutDirection = CLAY_LEFT_TO_RIGHT;
+        return d;
+    }
+
+    Clay_ElementDeclaration menu_pop_up_style(const GUIStuff::Theme& theme) {
+        Clay_ElementDeclaration d = window_style(theme);
+        d.floating = {.attachPoints = {.element = CLAY_ATTACH_POINT_LEFT_TOP, .parent = CLAY_ATTACH_POINT_LEFT_BOTTOM}, .attachTo = CLAY_ATTACH_TO_PARENT};
+        return d;
+    }
+
+    Clay_ElementDeclaration color_panel_style(const GUIStuff::Theme& theme) {
+        Clay_ElementDeclaration d = window_style(theme);
+        d.layout.sizing = {.width = CLAY_SIZING_FIXED(300), .height = CLAY_SIZING_FIT(0)};
+        return d;
+    }
+
+    Clay_ElementDeclaration general_settings_menu_style(const GUIStuff::Theme& theme) {
+        Clay_ElementDeclaration d = centered_window_style(theme);
+        d.layout.sizing = {.width = CLAY_SIZING_FIT(500), .height = CLAY_SIZING_FIXED(500) };
+        d.layout.padding = {};
+        d.layout.childGap = 0;
+        return d;
+    }
+
+    Clay_ElementDeclaration file_picker_style(const GUIStuff::Theme& theme) {
+        Clay_ElementDeclaration d = centered_window_style(theme);
+        d.layout.sizing = {.width = CLAY_SIZING_FIXED(700), .height = CLAY_SIZING_FIXED(500) };
+        return d;
+    }
+}
+
 Toolbar::Toolbar(MainProgram& initMain):
     io(std::make_shared<GUIStuff::UpdateInputData>()),
     main(initMain)
@@ -18,6 +77,13 @@ Toolbar::Toolbar(MainProgram& initMain):
     io->theme = GUIStuff::get_default_dark_mode();
     io->theme->textTypeface = main.fonts.map["Roboto"];
     io->theme->fontSize = 20;
+
+    topToolbarStyle = gui.register_style(top_toolbar_style);
+    menuPopUpStyle = gui.register_style(menu_pop_up_style);
+    colorPanelStyle = gui.register_style(color_panel_style);
+    connectIPMenuStyle = gui.register_style(centered_window_style);
+    generalSettingsMenuStyle = gui.register_style(general_settings_menu_style);
+    filePickerStyle = gui.register_style(file_picker_style);
 }
 
 void Toolbar::open_file_selector(const std::string& filePickerName, const std::vector<std::string>& extensionFilters, const std::function<void(const std::filesystem::path&, const std::string& extensionSelected)>& postSelectionFunc) {
@@ -27,6 +93,7 @@ void Toolbar::open_file_selector(const std::string& filePickerName, const std::v
     filePicker.extensionSelected = extensionFilters.size() - 1;
     filePicker.filePickerWindowName = filePickerName;
     filePicker.postSelectionFunc = postSelectionFunc;
+    gui.request_update();
 }
 
 std::filesystem::path& Toolbar::file_selector_path() {
@@ -36,11 +103,13 @@ std::filesystem::path& Toolbar::file_selector_path() {
 void Toolbar::color_selector_left(Vector4f* color) {
     colorLeft = color;
     justAssignedColorLeft = true;
+    gui.request_update();
 }
 
 void Toolbar::color_selector_right(Vector4f* color) {
     colorRight = color;
     justAssignedColorRight = true;
+    gui.request_update();
 }
 
 nlohmann::json Toolbar::get_appearance_json() {
@@ -56,6 +125,7 @@ void Toolbar::set_appearance_json(const nlohmann::json& j) {
     j.at("darkMode").get_to(newDarkMode);
     j.at("guiScale").get_to(guiScale);
     j.at("gridType").get_to(main.grid.gridType);
+    gui.request_update();
 }
 
 void Toolbar::update() {
@@ -78,7 +148,24 @@ void Toolbar::update() {
     if(main.input.key(InputManager::KEY_SAVE_AS).pressed && !optionsMenuOpen && !filePicker.isOpen)
         save_as_func();
 
-    start_gui();
+    // The tab list isn't bound through pointers, so changes to it are checked here
+    uint64_t worldListHash = world_list_hash();
+    if(worldListHash != lastWorldListHash) {
+        lastWorldListHash = worldListHash;
+        gui.request_update();
+    }
+
+    // Keyboard shortcuts change tool state the toolbar shows without going through bound pointers, and keybind
+    // capture reads the last pressed key inside the frame, so key presses and releases update the GUI
+    if(keybindWaiting || keys_changed())
+        gui.request_update();
+
+    if(!start_gui()) {
+        // A focused text box still owns the keyboard on frames that are skipped
+        if(io->acceptingTextInput)
+            main.input.text_input_silence_everything();
+        return;
+    }
 
     CLAY({
         .layout = {
@@ -123,75 +210,52 @@ void Toolbar::save_as_func() {
 }
 
 void Toolbar::top_toolbar() {
-    CLAY({
-        .layout = {
-            .sizing = {.width = CLAY_SIZING_GROW(0), .height = CLAY_SIZING_FIT(0) },
-            .padding = CLAY_PADDING_ALL(io->theme->padding1),
-            .childGap = io->theme->childGap1,
-            .childAlignment = { .x = CLAY_ALIGN_X_LEFT, .y = CLAY_ALIGN_Y_CENTER},
-            .layoutDirection = CLAY_LEFT_TO_RIGHT
-        },
-        .backgroundColor = convert_vec4<Clay_Color>(io->theme->backColor1),
-        .cornerRadius = CLAY_CORNER_RADIUS(io->theme->windowCorners1),
-        .border = {.color = convert_vec4<Clay_Color>(io->theme->backColor2), .width = CLAY_BORDER_OUTSIDE(io->theme->windowBorders1)}
-    }) {
+    CLAY(gui.style(topToolbarStyle)) {
         gui.obstructing_window();
         bool menuPopUpJustOpen = false;
-        if(gui.svg_icon_button("Main Menu", "icons/menu.svg", menuPopUpOpen)) {
+        if(gui.svg_icon_button("Main Menu"_id, "icons/menu.svg", menuPopUpOpen)) {
             menuPopUpOpen = true;
             menuPopUpJustOpen = true;
         }
-        std::vector<std::pair<std::string, std::string>> tabNames;
+        std::pmr::vector<GUIStuff::MovableTabList::TabName> tabNames(io->frameArena);
         for(size_t i = 0; i < main.worlds.size(); i++)
             tabNames.emplace_back(main.worlds[i]->network_being_used() ? "icons/network.svg" : "", main.worlds[i]->name);
         std::optional<size_t> closedTab;
-        gui.tab_list("file tab list", tabNames, main.worldIndex, closedTab);
+        gui.tab_list("file tab list"_id, tabNames, main.worldIndex, closedTab);
         if(closedTab)
             main.set_tab_to_close(closedTab.value());
         if(menuPopUpOpen) {
-            CLAY({
-                .layout = {
-                    .sizing = {.width = CLAY_SIZING_FIT(300), .height = CLAY_SIZING_FIT(0) },
-                    .padding = CLAY_PADDING_ALL(io->theme->padding1),
-                    .childGap = io->theme->childGap1,
-                    .childAlignment = { .x = CLAY_ALIGN_X_CENTER, .y = CLAY_ALIGN_Y_TOP},
-                    .layoutDirection = CLAY_TOP_TO_BOTTOM
-                },
-                .backgroundColor = convert_vec4<Clay_Color>(io->theme->backColor1),
-                .cornerRadius = CLAY_CORNER_RADIUS(io->theme->windowCorners1),
-                .floating = {.attachPoints = {.element = CLAY_ATTACH_POINT_LEFT_TOP, .parent = CLAY_ATTACH_POINT_LEFT_BOTTOM}, .attachTo = CLAY_ATTACH_TO_PARENT},
-                .border = {.color = convert_vec4<Clay_Color>(io->theme->backColor2), .width = CLAY_BORDER_OUTSIDE(io->theme->windowBorders1)}
-            }) {
+            CLAY(gui.style(menuPopUpStyle)) {
                 gui.obstructing_window();
-                if(gui.text_button_wide("new file local", "New File"))
+                if(gui.text_button_wide("new file local"_id, "New File"))
                     main.new_tab(World::CONNECTIONTYPE_LOCAL, "");
-                if(gui.text_button_wide("save file", "Save"))
+                if(gui.text_button_wide("save file"_id, "Save"))
                     save_func();
-                if(gui.text_button_wide("save as file", "Save As"))
+                if(gui.text_button_wide("save as file"_id, "Save As"))
                     save_as_func();
-                if(gui.text_button_wide("open file", "Open")) {
+                if(gui.text_button_wide("open file"_id, "Open")) {
                     open_file_selector("Open", {".", World::FILE_EXTENSION}, [&](const std::filesystem::path& p, const std::string& e) {
                         main.new_tab(World::CONNECTIONTYPE_LOCAL, p.string());
                     });
                 }
                 if(!main.net_server_hosted()) {
-                    if(gui.text_button_wide("start hosting", "Host New Server"))
+                    if(gui.text_button_wide("start hosting"_id, "Host New Server"))
                         main.new_tab(World::CONNECTIONTYPE_SERVER, "");
-                    if(gui.text_button_wide("start hosting file", "Host Server From File")) {
+                    if(gui.text_button_wide("start hosting file"_id, "Host Server From File")) {
                         open_file_selector("Open", {".", World::FILE_EXTENSION}, [&](const std::filesystem::path& p, const std::string& e) {
                             main.new_tab(World::CONNECTIONTYPE_SERVER, p.string());
                         });
                     }
                 }
-                if(gui.text_button_wide("connect to ip new file", "Connect to IP")) {
+                if(gui.text_button_wide("connect to ip new file"_id, "Connect to IP")) {
                     optionsMenuOpen = true;
                     optionsMenuType = CONNECT_IP_MENU;
                 }
-                if(gui.text_button_wide("open options", "Settings")) {
+                if(gui.text_button_wide("open options"_id, "Settings")) {
                     optionsMenuOpen = true;
                     optionsMenuType = GENERAL_SETTINGS_MENU;
                 }
-                if(gui.text_button_wide("quit button", "Quit"))
+                if(gui.text_button_wide("quit button"_id, "Quit"))
                     main.setToQuit = true;
                 if(io->mouse.leftClick && !menuPopUpJustOpen)
                     menuPopUpOpen = false;
@@ -211,20 +275,9 @@ void Toolbar::drawing_program_gui() {
     }) {
         main.world->drawProg.toolbar_gui();
         if(colorLeft) {
-            CLAY({
-                .layout = {
-                    .sizing = {.width = CLAY_SIZING_FIXED(300), .height = CLAY_SIZING_FIT(0)},
-                    .padding = CLAY_PADDING_ALL(io->theme->padding1),
-                    .childGap = io->theme->childGap1,
-                    .childAlignment = { .x = CLAY_ALIGN_X_CENTER, .y = CLAY_ALIGN_Y_TOP},
-                    .layoutDirection = CLAY_TOP_TO_BOTTOM
-                },
-                .backgroundColor = convert_vec4<Clay_Color>(io->theme->backColor1),
-                .cornerRadius = CLAY_CORNER_RADIUS(io->theme->windowCorners1),
-                .border = {.color = convert_vec4<Clay_Color>(io->theme->backColor2), .width = CLAY_BORDER_OUTSIDE(io->theme->windowBorders1)}
-            }) {
+            CLAY(gui.style(colorPanelStyle)) {
                 gui.obstructing_window();
-                gui.color_picker_items("colorpickerleft", colorLeft, true);
+                gui.color_picker_items("colorpickerleft"_id, colorLeft, true);
                 if(!Clay_Hovered() && !justAssignedColorLeft && io->mouse.leftClick)
                     colorLeft = nullptr;
             }
@@ -235,20 +288,9 @@ void Toolbar::drawing_program_gui() {
             }
         }) {}
         if(colorRight) {
-            CLAY({
-                .layout = {
-                    .sizing = {.width = CLAY_SIZING_FIXED(300), .height = CLAY_SIZING_FIT(0)},
-                    .padding = CLAY_PADDING_ALL(io->theme->padding1),
-                    .childGap = io->theme->childGap1,
-                    .childAlignment = { .x = CLAY_ALIGN_X_CENTER, .y = CLAY_ALIGN_Y_TOP},
-                    .layoutDirection = CLAY_TOP_TO_BOTTOM
-                },
-                .backgroundColor = convert_vec4<Clay_Color>(io->theme->backColor1),
-                .cornerRadius = CLAY_CORNER_RADIUS(io->theme->windowCorners1),
-                .border = {.color = convert_vec4<Clay_Color>(io->theme->backColor2), .width = CLAY_BORDER_OUTSIDE(io->theme->windowBorders1)}
-            }) {
+            CLAY(gui.style(colorPanelStyle)) {
                 gui.obstructing_window();
-                gui.color_picker_items("colorpickerright", colorRight, true);
+                gui.color_picker_items("colorpickerright"_id, colorRight, true);
                 if(!Clay_Hovered() && !justAssignedColorRight && io->mouse.leftClick)
                     colorRight = nullptr;
             }
@@ -260,43 +302,21 @@ void Toolbar::drawing_program_gui() {
 void Toolbar::options_menu() {
     switch(optionsMenuType) {
         case CONNECT_IP_MENU: {
-            CLAY({
-                .layout = {
-                    .sizing = {.width = CLAY_SIZING_FIT(300), .height = CLAY_SIZING_FIT(0) },
-                    .padding = CLAY_PADDING_ALL(io->theme->padding1),
-                    .childGap = io->theme->childGap1,
-                    .childAlignment = { .x = CLAY_ALIGN_X_CENTER, .y = CLAY_ALIGN_Y_TOP},
-                    .layoutDirection = CLAY_TOP_TO_BOTTOM
-                },
-                .backgroundColor = convert_vec4<Clay_Color>(io->theme->backColor1),
-                .cornerRadius = CLAY_CORNER_RADIUS(io->theme->windowCorners1),
-                .floating = {.attachPoints = {.element = CLAY_ATTACH_POINT_CENTER_CENTER, .parent = CLAY_ATTACH_POINT_CENTER_CENTER}, .attachTo = CLAY_ATTACH_TO_PARENT},
-                .border = {.color = convert_vec4<Clay_Color>(io->theme->backColor2), .width = CLAY_BORDER_OUTSIDE(io->theme->windowBorders1)}
-            }) {
+            CLAY(gui.style(connectIPMenuStyle)) {
                 gui.obstructing_window();
-                gui.input_text_field("connect IP input field", "IP", &ipToConnectTo);
-                if(gui.text_button_wide("do connect ip", "Connect IP")) {
+                gui.input_text_field("connect IP input field"_id, "IP", &ipToConnectTo);
+                if(gui.text_button_wide("do connect ip"_id, "Connect IP")) {
                     main.new_tab(World::CONNECTIONTYPE_CLIENT, ipToConnectTo);
                     optionsMenuOpen = false;
                 }
-                if(gui.text_button_wide("cancel connect ip", "Cancel"))
+                if(gui.text_button_wide("cancel connect ip"_id, "Cancel"))
                     optionsMenuOpen = false;
             }
             break;
         }
         case GENERAL_SETTINGS_MENU: {
-            CLAY({
-                .layout = {
-                    .sizing = {.width = CLAY_SIZING_FIT(500), .height = CLAY_SIZING_FIXED(500) },
-                    .childAlignment = { .x = CLAY_ALIGN_X_CENTER, .y = CLAY_ALIGN_Y_TOP},
-                    .layoutDirection = CLAY_TOP_TO_BOTTOM
-                },
-                .backgroundColor = convert_vec4<Clay_Color>(io->theme->backColor1),
-                .cornerRadius = CLAY_CORNER_RADIUS(io->theme->windowCorners1),
-                .floating = {.attachPoints = {.element = CLAY_ATTACH_POINT_CENTER_CENTER, .parent = CLAY_ATTACH_POINT_CENTER_CENTER}, .attachTo = CLAY_ATTACH_TO_PARENT},
-                .border = {.color = convert_vec4<Clay_Color>(io->theme->backColor2), .width = CLAY_BORDER_OUTSIDE(io->theme->windowBorders1)}
-            }) {
-                gui.push_id("gsettings");
+            CLAY(gui.style(generalSettingsMenuStyle)) {
+                gui.push_id("gsettings"_id);
                 CLAY({
                     .layout = {
                         .sizing = {.width = CLAY_SIZING_GROW(0), .height = CLAY_SIZING_GROW(0)},
@@ -316,8 +336,8 @@ void Toolbar::options_menu() {
                             .layoutDirection = CLAY_TOP_TO_BOTTOM
                         }
                     }) {
-                        if(gui.text_button_wide("Appearancebutton", "Appearance", generalSettingsOptions == GSETTINGS_APPEARANCE)) generalSettingsOptions = GSETTINGS_APPEARANCE;
-                        if(gui.text_button_wide("Keybindsbutton", "Keybinds", generalSettingsOptions == GSETTINGS_KEYBINDS)) generalSettingsOptions = GSETTINGS_KEYBINDS;
+                        if(gui.text_button_wide("Appearancebutton"_id, "Appearance", generalSettingsOptions == GSETTINGS_APPEARANCE)) generalSettingsOptions = GSETTINGS_APPEARANCE;
+                        if(gui.text_button_wide("Keybindsbutton"_id, "Keybinds", generalSettingsOptions == GSETTINGS_KEYBINDS)) generalSettingsOptions = GSETTINGS_KEYBINDS;
                     }
                     CLAY({
                         .layout = {
@@ -328,7 +348,7 @@ void Toolbar::options_menu() {
                     }) {
                         switch(generalSettingsOptions) {
                             case GSETTINGS_APPEARANCE: {
-                                gui.scroll_bar_area("general settings appearance", [&](float, float, float) {
+                                gui.scroll_bar_area("general settings appearance"_id, [&](float, float, float) {
                                     CLAY({
                                         .layout = {
                                             .sizing = {.width = CLAY_SIZING_GROW(0), .height = CLAY_SIZING_GROW(0) },
@@ -338,12 +358,12 @@ void Toolbar::options_menu() {
                                             .layoutDirection = CLAY_TOP_TO_BOTTOM
                                         }
                                     }) {
-                                        if(gui.radio_button_field("grid type no grid", "No Grid", (main.grid.gridType == GridManager::GRIDTYPE_NONE))) main.grid.gridType = GridManager::GRIDTYPE_NONE;
-                                        if(gui.radio_button_field("grid type circle grid", "Circle Dot Grid", (main.grid.gridType == GridManager::GRIDTYPE_CIRCLEDOT))) main.grid.gridType = GridManager::GRIDTYPE_CIRCLEDOT;
-                                        if(gui.radio_button_field("grid type square grid", "Square Dot Grid", (main.grid.gridType == GridManager::GRIDTYPE_SQUAREDOT))) main.grid.gridType = GridManager::GRIDTYPE_SQUAREDOT;
-                                        if(gui.radio_button_field("grid type line grid", "Line Grid", (main.grid.gridType == GridManager::GRIDTYPE_LINE))) main.grid.gridType = GridManager::GRIDTYPE_LINE;
-                                        gui.input_scalar_field("GUI Scale", "GUI Scale", &guiScale, 0.5f, 3.0f);
-                                        gui.checkbox_field("dark mode gui check", "Dark Mode GUI", &newDarkMode);
+                                        if(gui.radio_button_field("grid type no grid"_id, "No Grid", (main.grid.gridType == GridManager::GRIDTYPE_NONE))) main.grid.gridType = GridManager::GRIDTYPE_NONE;
+                                        if(gui.radio_button_field("grid type circle grid"_id, "Circle Dot Grid", (main.grid.gridType == GridManager::GRIDTYPE_CIRCLEDOT))) main.grid.gridType = GridManager::GRIDTYPE_CIRCLEDOT;
+                                        if(gui.radio_button_field("grid type square grid"_id, "Square Dot Grid", (main.grid.gridType == GridManager::GRIDTYPE_SQUAREDOT))) main.grid.gridType = GridManager::GRIDTYPE_SQUAREDOT;
+                                        if(gui.radio_button_field("grid type line grid"_id, "Line Grid", (main.grid.gridType == GridManager::GRIDTYPE_LINE))) main.grid.gridType = GridManager::GRIDTYPE_LINE;
+                                        gui.input_scalar_field("GUI Scale"_id, "GUI Scale", &guiScale, 0.5f, 3.0f);
+                                        gui.checkbox_field("dark mode gui check"_id, "Dark Mode GUI", &newDarkMode);
                                     }
                                 });
                                 break;
@@ -368,7 +388,7 @@ void Toolbar::options_menu() {
                                     }
                                 }
 
-                                gui.scroll_bar_area("general settings keybinds", [&](float, float, float) {
+                                gui.scroll_bar_area("general settings keybinds"_id, [&](float, float, float) {
                                     for(size_t i = 0; i < InputManager::KEY_ASSIGNABLE_COUNT; i++) {
                                         gui.push_id(i);
                                         CLAY({
@@ -380,12 +400,12 @@ void Toolbar::options_menu() {
                                                 .layoutDirection = CLAY_LEFT_TO_RIGHT 
                                             }
                                         }) {
-                                            gui.text_label(nlohmann::json(static_cast<InputManager::KeyCodeEnum>(i)));
+                                            gui.text_label(nlohmann::json(static_cast<InputManager::KeyCodeEnum>(i)).get_ref<const std::string&>());
                                             auto f = std::find_if(main.input.keyAssignments.begin(), main.input.keyAssignments.end(), [&](auto& p) {
                                                 return p.second == i;
                                             });
                                             std::string assignedKeystrokeStr = f != main.input.keyAssignments.end() ? main.input.key_assignment_to_str(f->first) : "";
-                                            if(gui.text_button_wide("keybind button", assignedKeystrokeStr, keybindWaiting.has_value() && keybindWaiting.value() == i))
+                                            if(gui.text_button_wide("keybind button"_id, assignedKeystrokeStr, keybindWaiting.has_value() && keybindWaiting.value() == i))
                                                 keybindWaiting = i;
                                         }
                                         gui.pop_id();
@@ -394,7 +414,7 @@ void Toolbar::options_menu() {
                                 break;
                             }
                         }
-                        if(gui.text_button_wide("done menu", "Done")) {
+                        if(gui.text_button_wide("done menu"_id, "Done")) {
                             main.save_config();
                             optionsMenuOpen = false;
                         }
@@ -408,30 +428,18 @@ void Toolbar::options_menu() {
 }
 
 void Toolbar::file_picker_gui() {
-    gui.push_id("filepicker");
+    gui.push_id("filepicker"_id);
     bool isDoneByDoubleClick = false;
-    CLAY({
-        .layout = {
-            .sizing = {.width = CLAY_SIZING_FIXED(700), .height = CLAY_SIZING_FIXED(500) },
-            .padding = CLAY_PADDING_ALL(io->theme->padding1),
-            .childGap = io->theme->childGap1,
-            .childAlignment = { .x = CLAY_ALIGN_X_CENTER, .y = CLAY_ALIGN_Y_TOP},
-            .layoutDirection = CLAY_TOP_TO_BOTTOM
-        },
-        .backgroundColor = convert_vec4<Clay_Color>(io->theme->backColor1),
-        .cornerRadius = CLAY_CORNER_RADIUS(io->theme->windowCorners1),
-        .floating = {.attachPoints = {.element = CLAY_ATTACH_POINT_CENTER_CENTER, .parent = CLAY_ATTACH_POINT_CENTER_CENTER}, .attachTo = CLAY_ATTACH_TO_PARENT},
-        .border = {.color = convert_vec4<Clay_Color>(io->theme->backColor2), .width = CLAY_BORDER_OUTSIDE(io->theme->windowBorders1)}
-    }) {
+    CLAY(gui.style(filePickerStyle)) {
         gui.obstructing_window();
         gui.text_label_centered(filePicker.filePickerWindowName);
         gui.left_to_right_line_layout([&]() {
-            if(gui.svg_icon_button("file picker back button", "icons/backarrow.svg", false, 30.0f)) {
+            if(gui.svg_icon_button("file picker back button"_id, "icons/backarrow.svg", false, 30.0f)) {
                 filePicker.currentSearchPath = filePicker.currentSearchPath.parent_path();
                 filePicker.refreshEntries = true;
             }
             std::filesystem::path pathDiff = filePicker.currentSearchPath;
-            gui.input_path_field("file picker path", "Path", &filePicker.currentSearchPath, std::filesystem::file_type::directory);
+            gui.input_path_field("file picker path"_id, "Path", &filePicker.currentSearchPath, std::filesystem::file_type::directory);
             if(pathDiff != filePicker.currentSearchPath)
                 filePicker.refreshEntries = true;
         });
@@ -463,10 +471,13 @@ void Toolbar::file_picker_gui() {
                         return false;
                     return std::lexicographical_compare(aStr.begin(), aStr.end(), bStr.begin(), bStr.end());
                 });
+                filePicker.entryNames.clear();
+                for(const std::filesystem::path& entry : filePicker.entries)
+                    filePicker.entryNames.emplace_back(entry.filename().string());
                 filePicker.refreshEntries = false;
             }
             float entryHeight = 25.0f;
-            gui.scroll_bar_many_entries_area("file picker entries", entryHeight, filePicker.entries.size(), [&](size_t i, bool isListHovered) {
+            gui.scroll_bar_many_entries_area("file picker entries"_id, entryHeight, filePicker.entries.size(), [&](size_t i, bool isListHovered) {
                 const std::filesystem::path& entry = filePicker.entries[i];
                 bool selectedEntry = filePicker.currentSelectedPath == entry;
                 CLAY({
@@ -484,11 +495,11 @@ void Toolbar::file_picker_gui() {
                         },
                     }) {
                         if(std::filesystem::is_directory(entry))
-                            gui.svg_icon("folder icon", "icons/folder.svg", selectedEntry);
+                            gui.svg_icon("folder icon"_id, "icons/folder.svg", selectedEntry);
                         else
-                            gui.svg_icon("file icon", "icons/file.svg", selectedEntry);
+                            gui.svg_icon("file icon"_id, "icons/file.svg", selectedEntry);
                     }
-                    gui.text_label(entry.filename().string());
+                    gui.text_label(filePicker.entryNames[i]);
                     if(Clay_Hovered() && io->mouse.leftClick && isListHovered) {
                         if(selectedEntry && io->mouse.leftClick >= 2) {
                             if(std::filesystem::is_directory(entry)) {
@@ -508,22 +519,22 @@ void Toolbar::file_picker_gui() {
             });
         }
         gui.left_to_right_line_layout([&]() {
-            gui.input_text("filepicker filename", &filePicker.fileName);
+            gui.input_text("filepicker filename"_id, &filePicker.fileName);
             size_t oldExtensionSelected = filePicker.extensionSelected;
-            gui.dropdown_select("filepicker select type", &filePicker.extensionSelected, filePicker.extensionFilters);
+            gui.dropdown_select("filepicker select type"_id, &filePicker.extensionSelected, filePicker.extensionFilters);
             if(oldExtensionSelected != filePicker.extensionSelected)
                 filePicker.refreshEntries = true;
         });
         gui.left_to_right_line_layout([&]() {
             std::filesystem::path pathToRet = std::filesystem::path();
-            if(gui.text_button_wide("filepicker done", "Done") || isDoneByDoubleClick) {
+            if(gui.text_button_wide("filepicker done"_id, "Done") || isDoneByDoubleClick) {
                 if(!filePicker.fileName.empty()) {
                     pathToRet = filePicker.currentSearchPath / filePicker.fileName;
                     filePicker.postSelectionFunc(pathToRet, filePicker.extensionFilters[filePicker.extensionSelected]);
                 }
                 filePicker.isOpen = false;
             }
-            if(gui.text_button_wide("filepicker cancel", "Cancel")) {
+            if(gui.text_button_wide("filepicker cancel"_id, "Cancel")) {
                 filePicker.isOpen = false;
             }
         });
@@ -531,7 +542,31 @@ void Toolbar::file_picker_gui() {
     gui.pop_id();
 }
 
-void Toolbar::start_gui() {
+uint64_t Toolbar::world_list_hash() {
+    uint64_t h = 0;
+    hash_combine(h, main.worldIndex);
+    hash_combine(h, &(*main.world));
+    for(auto& w : main.worlds) {
+        hash_combine(h, std::string_view(w->name));
+        hash_combine(h, w->network_being_used());
+    }
+    return h;
+}
+
+bool Toolbar::keys_changed() {
+    bool changed = false;
+    lastKeysHeld.resize(InputManager::KEY_ASSIGNABLE_COUNT, false);
+    for(size_t i = 0; i < InputManager::KEY_ASSIGNABLE_COUNT; i++) {
+        const auto& k = main.input.key(static_cast<InputManager::KeyCodeEnum>(i));
+        if(k.pressed || k.held != lastKeysHeld[i]) {
+            lastKeysHeld[i] = k.held;
+            changed = true;
+        }
+    }
+    return changed;
+}
+
+bool Toolbar::start_gui() {
     io->mouse.leftClick = main.input.mouse.leftClicks;
     io->mouse.leftHeld = main.input.mouse.leftDown;
     io->mouse.globalPos = main.input.mouse.pos / guiScale;
@@ -558,11 +593,16 @@ void Toolbar::start_gui() {
 
     gui.windowPos = Vector2f{0.0f, 0.0f};
     gui.windowSize = main.window.size.cast<float>() / guiScale;
-    io->hoverObstructed = false;
-    io->acceptingTextInput = false;
     gui.io = io;
 
+    // hoverObstructed and acceptingTextInput keep last frame's values when the frame is skipped, since the mouse hasn't moved
+    if(!gui.needs_update())
+        return false;
+
+    io->hoverObstructed = false;
+    io->acceptingTextInput = false;
     gui.begin();
+    return true;
 }
 
 void Toolbar::end_gui() {
@@ -574,8 +614,31 @@ void Toolbar::end_gui() {
 }
 
 void Toolbar::draw(SkCanvas* canvas) {
-    canvas->save();
-    canvas->scale(guiScale, guiScale);
-    gui.draw(canvas);
-    canvas->restore();
+    // The GUI is kept in its own surface, where only the parts that changed are drawn again
+    if(!guiSurface || guiSurface->width() != main.window.size.x() || guiSurface->height() != main.window.size.y() || guiSurfaceScale != guiScale) {
+        guiSurface = canvas->makeSurface(SkImageInfo::MakeN32Premul(main.window.size.x(), main.window.size.y()));
+        guiSurfaceScale = guiScale;
+        guiSurfaceDrawn = false;
+    }
+    if(!guiSurface) {
+        canvas->save();
+        canvas->scale(guiScale, guiScale);
+        gui.draw(canvas);
+        canvas->restore();
+        return;
+    }
+    if(!guiSurfaceDrawn || gui.needs_redraw()) {
+        SkCanvas* guiCanvas = guiSurface->getCanvas();
+        guiCanvas->save();
+        guiCanvas->scale(guiScale, guiScale);
+        if(guiSurfaceDrawn)
+            gui.draw_damaged(guiCanvas);
+        else {
+            guiCanvas->clear(SK_ColorTRANSPARENT);
+            gui.draw(guiCanvas);
+        }
+        guiCanvas->restore();
+        guiSurfaceDrawn = true;
+    }
+    guiSurface->draw(canvas, 0, 0);
 }
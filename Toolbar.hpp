@@ -1,6 +1,7 @@
 #pragma once
 #include "GUIStuff/GUIManager.hpp"
 #include "DrawData.hpp"
+#include "include/core/SkSurface.h"
 #include <filesystem>
 #include <nlohmann/json.hpp>
 
@@ -31,6 +32,13 @@ class Toolbar {
         void options_menu();
         void file_picker_gui();
 
+        GUIStuff::GUIManager::StyleHandle topToolbarStyle;
+        GUIStuff::GUIManager::StyleHandle menuPopUpStyle;
+        GUIStuff::GUIManager::StyleHandle colorPanelStyle;
+        GUIStuff::GUIManager::StyleHandle connectIPMenuStyle;
+        GUIStuff::GUIManager::StyleHandle generalSettingsMenuStyle;
+        GUIStuff::GUIManager::StyleHandle filePickerStyle;
+
         bool justAssignedColorLeft = false;
         bool justAssignedColorRight = false;
 
@@ -55,6 +63,7 @@ class Toolbar {
             std::string filePickerWindowName;
             std::vector<std::string> extensionFilters;
             std::vector<std::filesystem::path> entries;
+            std::vector<std::string> entryNames; // Filenames of entries, so they aren't converted every frame
             bool refreshEntries = true;
             std::filesystem::path currentSearchPath;
             std::filesystem::path currentSelectedPath;
@@ -67,8 +76,17 @@ class Toolbar {
 
         std::filesystem::path testing;
 
-        void start_gui();
+        sk_sp<SkSurface> guiSurface; // Null if the canvas can't make surfaces, then the GUI is drawn straight to it every frame
+        float guiSurfaceScale = 1.0f;
+        bool guiSurfaceDrawn = false;
+
+        bool start_gui(); // Returns false when nothing changed, and the frame is skipped
         void end_gui();
+        uint64_t world_list_hash();
+        bool keys_changed();
+
+        uint64_t lastWorldListHash = 0;
+        std::vector<bool> lastKeysHeld;
 
         std::string ipToConnectTo;
 